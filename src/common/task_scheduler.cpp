@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler.cpp
+//
+// Identification: src/common/task_scheduler.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/task_scheduler.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void TaskGroup::RunParallel(uint32_t num_tasks, const std::function<void(uint32_t)> &task) {
+  Batch batch{&task, num_tasks, nullptr};
+  scheduler_->Submit(this, &batch, num_tasks);
+  std::unique_lock<std::mutex> lock(scheduler_->latch_);
+  scheduler_->RunTask(this, Task{&batch, 0}, &lock);
+  scheduler_->Help(this, &batch, &lock);
+  lock.unlock();
+  if (batch.exception_ != nullptr) {
+    std::rethrow_exception(batch.exception_);
+  }
+}
+
+TaskScheduler::TaskScheduler(uint32_t num_workers) {
+  workers_.reserve(num_workers);
+  for (uint32_t i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&TaskScheduler::WorkerLoop, this);
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::scoped_lock lock(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+auto TaskScheduler::CreateTaskGroup(int priority, uint32_t max_concurrency) -> std::unique_ptr<TaskGroup> {
+  return std::unique_ptr<TaskGroup>(new TaskGroup(this, priority, max_concurrency));
+}
+
+void TaskScheduler::Submit(TaskGroup *group, TaskGroup::Batch *batch, uint32_t num_tasks) {
+  if (num_tasks <= 1) {
+    return;
+  }
+  {
+    std::scoped_lock lock(latch_);
+    if (group->tasks_.empty()) {
+      active_groups_.push_back(group);
+    }
+    for (uint32_t task_idx = 1; task_idx < num_tasks; task_idx++) {
+      group->tasks_.push_back(TaskGroup::Task{batch, task_idx});
+    }
+  }
+  cv_.notify_all();
+}
+
+void TaskScheduler::Help(TaskGroup *group, TaskGroup::Batch *batch, std::unique_lock<std::mutex> *lock) {
+  while (batch->remaining_ > 0) {
+    if (group->tasks_.empty()) {
+      // The rest of the batch is running on workers
+      cv_.wait(*lock);
+      continue;
+    }
+    // Newest first: with nested calls this finishes the innermost batch before returning to outer ones
+    auto task = group->tasks_.back();
+    group->tasks_.pop_back();
+    if (group->tasks_.empty()) {
+      active_groups_.erase(std::find(active_groups_.begin(), active_groups_.end(), group));
+    }
+    RunTask(group, task, lock);
+  }
+}
+
+void TaskScheduler::RunTask(TaskGroup *group, const TaskGroup::Task &task, std::unique_lock<std::mutex> *lock) {
+  auto *batch = task.batch_;
+  lock->unlock();
+  std::exception_ptr exception;
+  if (!group->IsCancelled()) {
+    try {
+      (*batch->task_)(task.task_idx_);
+    } catch (...) {
+      exception = std::current_exception();
+    }
+  }
+  lock->lock();
+  if (exception != nullptr && batch->exception_ == nullptr) {
+    batch->exception_ = exception;
+  }
+  if (--batch->remaining_ == 0) {
+    cv_.notify_all();
+  }
+}
+
+auto TaskScheduler::PickGroup() -> TaskGroup * {
+  TaskGroup *best = nullptr;
+  for (auto *group : active_groups_) {
+    if (group->running_ >= group->max_concurrency_) {
+      continue;
+    }
+    if (best == nullptr || group->priority_ > best->priority_ ||
+        (group->priority_ == best->priority_ && group->last_served_ < best->last_served_)) {
+      best = group;
+    }
+  }
+  return best;
+}
+
+void TaskScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    TaskGroup *group = nullptr;
+    cv_.wait(lock, [&] { return shutdown_ || (group = PickGroup()) != nullptr; });
+    if (shutdown_) {
+      return;
+    }
+    // Oldest first, so the tasks a waiting thread queued last are left for it to run itself
+    auto task = group->tasks_.front();
+    group->tasks_.pop_front();
+    if (group->tasks_.empty()) {
+      active_groups_.erase(std::find(active_groups_.begin(), active_groups_.end(), group));
+    }
+    group->last_served_ = ++clock_;
+    group->running_++;
+    RunTask(group, task, &lock);
+    group->running_--;
+    // A worker slot of a capped group may have been the only thing keeping other workers idle
+    cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
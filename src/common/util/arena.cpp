@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena.cpp
+//
+// Identification: src/common/util/arena.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+auto Arena::Allocate(size_t size, size_t alignment) -> char * {
+  auto padding = (alignment - reinterpret_cast<uintptr_t>(cursor_) % alignment) % alignment;
+  if (cursor_ == nullptr || padding + size > remaining_) {
+    // Large allocations get a block of their own so the current block keeps its free space.
+    auto block_size = std::max(next_block_size_, size + alignment);
+    Charge(block_size);
+    blocks_.emplace_back(new char[block_size]);
+    block_bytes_ += block_size;
+    if (block_size == next_block_size_) {
+      next_block_size_ = std::min(next_block_size_ * 2, MAX_BLOCK_SIZE);
+    }
+    cursor_ = blocks_.back().get();
+    remaining_ = block_size;
+    padding = (alignment - reinterpret_cast<uintptr_t>(cursor_) % alignment) % alignment;
+  }
+  char *result = cursor_ + padding;
+  cursor_ = result + size;
+  remaining_ -= padding + size;
+  return result;
+}
+
+auto Arena::Copy(const char *data, size_t size) -> char * {
+  char *copy = Allocate(size, 1);
+  std::memcpy(copy, data, size);
+  return copy;
+}
+
+void Arena::Reserve(size_t bytes) {
+  Charge(bytes);
+  reserved_bytes_ += bytes;
+}
+
+void Arena::Release(size_t bytes) {
+  BUSTUB_ASSERT(bytes <= reserved_bytes_, "Cannot release more memory than was reserved.");
+  Uncharge(bytes);
+  reserved_bytes_ -= bytes;
+}
+
+void Arena::Reset() {
+  blocks_.clear();
+  Uncharge(block_bytes_ + reserved_bytes_);
+  block_bytes_ = 0;
+  reserved_bytes_ = 0;
+  cursor_ = nullptr;
+  remaining_ = 0;
+  next_block_size_ = MIN_BLOCK_SIZE;
+}
+
+void Arena::Charge(size_t bytes) {
+  auto used = used_.fetch_add(bytes) + bytes;
+  if (used > limit_) {
+    used_.fetch_sub(bytes);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "query memory limit exceeded");
+  }
+  if (parent_ != nullptr) {
+    try {
+      parent_->Charge(bytes);
+    } catch (Exception &e) {
+      used_.fetch_sub(bytes);
+      throw;
+    }
+  }
+  auto peak = peak_.load();
+  while (used > peak && !peak_.compare_exchange_weak(peak, used)) {
+  }
+}
+
+void Arena::Uncharge(size_t bytes) {
+  for (Arena *arena = this; arena != nullptr; arena = arena->parent_) {
+    arena->used_.fetch_sub(bytes);
+  }
+}
+
+}  // namespace bustub
@@ -10,7 +10,6 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -22,9 +21,9 @@
 
 namespace bustub {
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+                                     const KeyComparator &comparator, HashFn hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
   auto dir_page = buffer_pool_manager_->NewPage(&directory_page_id_);
   auto dir_page_data = reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData());
@@ -53,48 +52,42 @@ HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager
  * HELPERS
  *****************************************************************************/
 /**
- * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
- * for extendible hashing.
+ * Hash - returns the full 64-bit hash of the key.
  *
  * @param key the key to hash
- * @return the downcasted 32-bit hash
+ * @return the 64-bit hash
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
-uint32_t HASH_TABLE_TYPE::Hash(KeyType key) {
-  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
+uint64_t HASH_TABLE_TYPE::Hash(KeyType key) {
+  return hash_fn_.GetHash(key);
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) {
-  return Hash(key) & dir_page->GetGlobalDepthMask();
+  return static_cast<uint32_t>(Hash(key) & dir_page->GetGlobalDepthMask());
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 inline page_id_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) {
   return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
   return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 std::pair<Page *, HASH_TABLE_BUCKET_TYPE *> HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
   auto bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
   auto bucket_page_data = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
   return std::pair<Page *, HASH_TABLE_BUCKET_TYPE *>(bucket_page, bucket_page_data);
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
-uint32_t HASH_TABLE_TYPE::Pow(uint32_t base, uint32_t power) const {
-  return static_cast<uint32_t>(std::pow(static_cast<long double>(base), static_cast<long double>(power)));
-}
-
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
   table_latch_.RLock();
 
@@ -114,7 +107,7 @@ bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.RLock();
 
@@ -140,7 +133,7 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
   return success;
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.WLock();
 
@@ -162,6 +155,12 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
     if (bucket_page_data->IsFull()) {
       // first check whether we need to grow the directory
       if (dir_page_data->GetLocalDepth(bucket_idx) == dir_page_data->GetGlobalDepth()) {
+        // the directory page cannot address more buckets, give up on this insertion.
+        if (dir_page_data->Size() == DIRECTORY_ARRAY_SIZE) {
+          buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+          bucket_page->WUnlatch();
+          break;
+        }
         dir_page_data->IncrGlobalDepth();
         is_growing = true;
       }
@@ -181,7 +180,7 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
       while (num_read != num_readable) {
         if (bucket_page_data->IsReadable(num_read)) {
           auto key = bucket_page_data->KeyAt(num_read);
-          uint32_t which_bucket = Hash(key) & (Pow(2, dir_page_data->GetLocalDepth(bucket_idx)) - 1);
+          auto which_bucket = static_cast<uint32_t>(Hash(key) & dir_page_data->GetLocalDepthMask(bucket_idx));
           if ((which_bucket ^ split_bucket_idx) == 0) {
             // remove from the original bucket and insert the new bucket
             auto value = bucket_page_data->ValueAt(num_read);
@@ -195,11 +194,11 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
 
       // redirect the reset of the buckets.
       //! for more info, see VerifyIntegrity().
-      for (uint32_t i = Pow(2, old_global_depth); i < dir_page_data->Size(); i++) {
+      for (uint32_t i = 1U << old_global_depth; i < dir_page_data->Size(); i++) {
         if (i == split_bucket_idx) {
           continue;
         }
-        uint32_t redirect_bucket_idx = i & (Pow(2, old_global_depth) - 1);
+        uint32_t redirect_bucket_idx = i & ((1U << old_global_depth) - 1);
         dir_page_data->SetBucketPageId(i, dir_page_data->GetBucketPageId(redirect_bucket_idx));
         dir_page_data->SetLocalDepth(i, dir_page_data->GetLocalDepth(redirect_bucket_idx));
       }
@@ -220,7 +219,7 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.RLock();
 
@@ -250,7 +249,7 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
   table_latch_.WLock();
 
@@ -303,7 +302,7 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
   table_latch_.RLock();
   HashTableDirectoryPage *dir_page = FetchDirectoryPage();
@@ -316,7 +315,7 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
 /*****************************************************************************
  * VERIFY INTEGRITY - DO NOT TOUCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
   HashTableDirectoryPage *dir_page = FetchDirectoryPage();
@@ -336,4 +335,11 @@ template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class ExtendibleHashTable<int, int, IntComparator, MultiplyShiftHashFunction<int>>;
+#ifdef __SSE4_2__
+template class ExtendibleHashTable<int, int, IntComparator, Crc32cHashFunction<int>>;
+#endif
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>, FastIntegerHashFunction<GenericKey<4>>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>, FastIntegerHashFunction<GenericKey<8>>>;
+
 }  // namespace bustub
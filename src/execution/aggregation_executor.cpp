@@ -9,56 +9,310 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <vector>
 
+#include "common/exception.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "type/limits.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return a non-NULL integer-like value as an int64_t */
+auto GetInteger(const Value &value) -> int64_t {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    default:
+      return value.GetAs<int64_t>();
+  }
+}
+
+/** @return value as an INTEGER, throwing like INTEGER arithmetic if it is out of range */
+auto CheckedInteger(int64_t value) -> Value {
+  if (value < BUSTUB_INT32_MIN || value > BUSTUB_INT32_MAX) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+  }
+  return ValueFactory::GetIntegerValue(static_cast<int32_t>(value));
+}
+
+}  // namespace
+
+SimpleAggregationHashTable::SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
+                                                       const std::vector<AggregationType> &agg_types, Arena *arena)
+    : arena_{arena != nullptr ? std::make_unique<Arena>(arena) : nullptr},
+      agg_exprs_{agg_exprs},
+      agg_types_{agg_types} {
+  for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+    auto input_type = agg_exprs_[i]->GetReturnType();
+    if (agg_types_[i] == AggregationType::SumAggregate && input_type == TypeId::VARCHAR) {
+      throw NotImplementedException("SUM is only supported on numeric inputs");
+    }
+    input_types_.push_back(input_type);
+    // MIN and MAX of non-numeric inputs keep a Value and go through the Value comparison
+    bool value_state = agg_types_[i] != AggregationType::CountAggregate && input_type == TypeId::VARCHAR;
+    has_value_states_ = has_value_states_ || value_state;
+    value_states_used_.push_back(value_state);
+    auto column = dynamic_cast<const ColumnValueExpression *>(agg_exprs_[i]);
+    input_columns_.push_back(column != nullptr && column->GetTupleIdx() == 0 && !value_state ? column->GetColIdx()
+                                                                                             : NO_COLUMN);
+  }
+}
+
+auto SimpleAggregationHashTable::FindOrInsertGroup(hash_t hash, const AggregateKey &agg_key) -> AggregateState * {
+  auto num_aggs = agg_types_.size();
+  auto make_group = [this, num_aggs, &agg_key] {
+    if (arena_ != nullptr) {
+      // the entry of the map with the group's key Values, and the group's states
+      auto state_memory = sizeof(AggregateState) + (has_value_states_ ? sizeof(Value) : 0);
+      arena_->Reserve(sizeof(AggregationMap::Entry) + agg_key.group_bys_.size() * sizeof(Value) +
+                      num_aggs * state_memory);
+    }
+    // Groups are numbered in insertion order, like the entries of the map.
+    states_.resize(states_.size() + num_aggs, AggregateState{{0}, false});
+    if (has_value_states_) {
+      value_states_.resize(states_.size());
+    }
+    return static_cast<uint32_t>(ht_.Size());
+  };
+  auto group = *ht_.FindOrInsert(hash, agg_key, make_group).first;
+  return &states_[group * num_aggs];
+}
+
+void SimpleAggregationHashTable::CombineInteger(uint32_t i, AggregateState *state, int64_t input) const {
+  switch (agg_types_[i]) {
+    case AggregationType::CountAggregate:
+      state->count_++;
+      return;
+    case AggregationType::SumAggregate:
+      if (state->has_value_ && ((input > 0 && state->integer_ > BUSTUB_INT64_MAX - input) ||
+                                (input < 0 && state->integer_ < BUSTUB_INT64_MIN - input))) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+      }
+      state->integer_ = state->has_value_ ? state->integer_ + input : input;
+      break;
+    case AggregationType::MinAggregate:
+      state->integer_ = state->has_value_ ? std::min(state->integer_, input) : input;
+      break;
+    case AggregationType::MaxAggregate:
+      state->integer_ = state->has_value_ ? std::max(state->integer_, input) : input;
+      break;
+  }
+  state->has_value_ = true;
+}
+
+void SimpleAggregationHashTable::CombineDecimal(uint32_t i, AggregateState *state, double input) const {
+  switch (agg_types_[i]) {
+    case AggregationType::CountAggregate:
+      state->count_++;
+      return;
+    case AggregationType::SumAggregate:
+      state->decimal_ = state->has_value_ ? state->decimal_ + input : input;
+      break;
+    case AggregationType::MinAggregate:
+      state->decimal_ = state->has_value_ ? std::min(state->decimal_, input) : input;
+      break;
+    case AggregationType::MaxAggregate:
+      state->decimal_ = state->has_value_ ? std::max(state->decimal_, input) : input;
+      break;
+  }
+  state->has_value_ = true;
+}
+
+void SimpleAggregationHashTable::CombineValue(uint32_t i, AggregateState *state, const Value &input) {
+  if (agg_types_[i] == AggregationType::CountAggregate) {
+    // COUNT counts every row, NULL or not.
+    state->count_++;
+  } else if (input.IsNull()) {
+    return;
+  } else if (value_states_used_[i]) {
+    auto &current = value_states_[state - states_.data()];
+    if (!state->has_value_) {
+      current = input;
+    } else {
+      current = agg_types_[i] == AggregationType::MinAggregate ? current.Min(input) : current.Max(input);
+    }
+    state->has_value_ = true;
+  } else if (input_types_[i] == TypeId::DECIMAL) {
+    CombineDecimal(i, state, input.GetAs<double>());
+  } else {
+    CombineInteger(i, state, GetInteger(input));
+  }
+}
+
+void SimpleAggregationHashTable::InsertCombine(hash_t hash, const AggregateKey &agg_key,
+                                               const AggregateValue &agg_val) {
+  auto states = FindOrInsertGroup(hash, agg_key);
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    CombineValue(i, &states[i], agg_val.aggregates_[i]);
+  }
+}
+
+void SimpleAggregationHashTable::InsertCombine(hash_t hash, const AggregateKey &agg_key, const TupleBatch &batch,
+                                               uint32_t row) {
+  auto states = FindOrInsertGroup(hash, agg_key);
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    if (input_columns_[i] == NO_COLUMN) {
+      CombineValue(i, &states[i], agg_exprs_[i]->EvaluateBatchRow(&batch, row));
+      continue;
+    }
+    const auto &column = batch.GetColumn(input_columns_[i]);
+    if (agg_types_[i] == AggregationType::CountAggregate) {
+      states[i].count_++;
+    } else if (column.IsNull(row)) {
+      continue;
+    } else if (column.IsInteger()) {
+      CombineInteger(i, &states[i], column.GetIntegers()[row]);
+    } else {
+      CombineDecimal(i, &states[i], column.GetDecimals()[row]);
+    }
+  }
+}
+
+void SimpleAggregationHashTable::Merge(const SimpleAggregationHashTable &other) {
+  auto num_aggs = agg_types_.size();
+  for (size_t entry_idx = 0; entry_idx < other.ht_.Size(); entry_idx++) {
+    const auto &entry = other.ht_.EntryAt(entry_idx);
+    auto states = FindOrInsertGroup(entry.hash_, entry.key_);
+    auto first_partial = entry.value_ * num_aggs;
+    const auto *partials = &other.states_[first_partial];
+    for (uint32_t i = 0; i < num_aggs; i++) {
+      const auto &partial = partials[i];
+      if (agg_types_[i] == AggregationType::CountAggregate) {
+        states[i].count_ += partial.count_;
+      } else if (!partial.has_value_) {
+        continue;
+      } else if (value_states_used_[i]) {
+        CombineValue(i, &states[i], other.value_states_[first_partial + i]);
+      } else if (input_types_[i] == TypeId::DECIMAL) {
+        // A SUM combines partial sums, MIN and MAX partial minimums and maximums.
+        CombineDecimal(i, &states[i], partial.decimal_);
+      } else {
+        CombineInteger(i, &states[i], partial.integer_);
+      }
+    }
+  }
+}
+
+auto SimpleAggregationHashTable::Finalize(uint32_t group) const -> AggregateValue {
+  std::vector<Value> values;
+  values.reserve(agg_types_.size());
+  for (uint32_t i = 0; i < agg_types_.size(); i++) {
+    const auto &state = states_[group * agg_types_.size() + i];
+    auto input_type = input_types_[i];
+    if (agg_types_[i] == AggregationType::CountAggregate) {
+      values.emplace_back(CheckedInteger(static_cast<int64_t>(state.count_)));
+    } else if (!state.has_value_) {
+      values.emplace_back(ValueFactory::GetNullValueByType(input_type));
+    } else if (value_states_used_[i]) {
+      values.emplace_back(value_states_[group * agg_types_.size() + i]);
+    } else if (input_type == TypeId::DECIMAL) {
+      values.emplace_back(ValueFactory::GetDecimalValue(state.decimal_));
+    } else if (agg_types_[i] == AggregationType::SumAggregate && input_type != TypeId::BIGINT) {
+      // Integer sums are INTEGER unless the input is BIGINT, like the result of INTEGER + input.
+      values.emplace_back(CheckedInteger(state.integer_));
+    } else if (agg_types_[i] == AggregationType::SumAggregate) {
+      values.emplace_back(ValueFactory::GetBigIntValue(state.integer_));
+    } else {
+      values.emplace_back(input_type, state.integer_);
+    }
+  }
+  return {values};
+}
+
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx),
-      table_(plan->GetAggregates(), plan->GetAggregateTypes()),
-      iter_(table_.Begin()) {
+    : AbstractExecutor(exec_ctx), iter_(nullptr, 0) {
   plan_ = plan;
   child_ = std::move(child);
-  const auto &agg_exprs_ = plan_->GetAggregates();
-  Tuple tuple;
-  RID rid;
-  auto keys = std::move(table_.GenerateInitialAggregateValue().aggregates_);
+}
+
+void AggregationExecutor::Init() {
   child_->Init();
-  // 含有groupby字段的时候，就进行key，value映射
-  while (child_->Next(&tuple, &rid)) {
-    if (!plan_->GetGroupBys().empty()) {
-      const auto &group_bys = plan_->GetGroupBys();
-      keys.clear();
-      keys.reserve(group_bys.size());
-      for (auto group_by : group_bys) {
-        keys.emplace_back(group_by->Evaluate(&tuple, child_->GetOutputSchema()));
-      }
-    }
-    std::vector<Value> values;
-    for (auto agg_expr : agg_exprs_) {
-      values.emplace_back(agg_expr->Evaluate(&tuple, child_->GetOutputSchema()));
+  tables_.clear();
+  auto scan = dynamic_cast<SeqScanExecutor *>(child_.get());
+  if (scan != nullptr && scan->UseParallelScan()) {
+    BuildParallel(scan);
+  } else {
+    BuildSerial();
+  }
+  table_idx_ = 0;
+  iter_ = tables_[0].Begin();
+}
+
+void AggregationExecutor::BuildSerial() {
+  tables_.push_back(MakeTable());
+  TupleBatch batch(child_->GetOutputSchema());
+  while (child_->NextBatch(&batch)) {
+    for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+      auto row = batch.SelectedRow(i);
+      auto key = MakeAggregateKey(batch, row);
+      tables_[0].InsertCombine(std::hash<AggregateKey>()(key), key, batch, row);
     }
-    table_.InsertCombine(AggregateKey{keys}, AggregateValue{values});
   }
 }
 
-void AggregationExecutor::Init() {
-  iter_ = table_.Begin();
-  child_->Init();
+void AggregationExecutor::BuildParallel(SeqScanExecutor *scan) {
+  uint32_t num_threads = exec_ctx_->GetParallelism();
+  size_t num_partitions = size_t{1} << AGG_PARTITION_BITS;
+  // Phase 1: every scan thread pre-aggregates into its own partitioned tables, without any synchronization.
+  std::vector<std::vector<SimpleAggregationHashTable>> local_tables(num_threads);
+  for (auto &tables : local_tables) {
+    for (size_t partition = 0; partition < num_partitions; partition++) {
+      tables.push_back(MakeTable());
+    }
+  }
+  scan->ParallelScan(num_threads, [&](uint32_t thread_idx, const TupleBatch &batch) {
+    for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+      auto row = batch.SelectedRow(i);
+      auto key = MakeAggregateKey(batch, row);
+      auto hash = std::hash<AggregateKey>()(key);
+      auto partition = HashUtil::MixHash(hash) >> (64 - AGG_PARTITION_BITS);
+      local_tables[thread_idx][partition].InsertCombine(hash, key, batch, row);
+    }
+  });
+
+  // Phase 2: the partitions are disjoint in their keys, so each one is merged by a single thread.
+  for (size_t partition = 0; partition < num_partitions; partition++) {
+    tables_.push_back(MakeTable());
+  }
+  std::atomic<size_t> next_partition{0};
+  exec_ctx_->RunParallel(num_threads, [&](uint32_t /* thread_idx */) {
+    for (size_t partition = next_partition++; partition < num_partitions; partition = next_partition++) {
+      for (auto &tables : local_tables) {
+        tables_[partition].Merge(tables[partition]);
+        tables[partition].Clear();
+      }
+    }
+  });
 }
 
 auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   // 迭代器进行遍历
-  while (iter_ != table_.End()) {
-   auto temp = iter_;
+  while (true) {
+    if (iter_ == tables_[table_idx_].End()) {
+      if (table_idx_ + 1 == tables_.size()) {
+        return false;
+      }
+      iter_ = tables_[++table_idx_].Begin();
+      continue;
+    }
+    auto temp = iter_;
     ++iter_;
+    auto aggregates = temp.Val().aggregates_;
     // 用having过滤
     if (plan_->GetHaving() != nullptr) {
-      Value value = plan_->GetHaving()->EvaluateAggregate(temp.Key().group_bys_, temp.Val().aggregates_);
+      Value value = plan_->GetHaving()->EvaluateAggregate(temp.Key().group_bys_, aggregates);
       if (!value.GetAs<bool>()) {
         continue;
       }
@@ -67,12 +321,11 @@ auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     values.reserve(plan_->OutputSchema()->GetColumnCount());
     // 拿到tuple
     for (const Column &column : plan_->OutputSchema()->GetColumns()) {
-      values.emplace_back(column.GetExpr()->EvaluateAggregate(temp.Key().group_bys_, temp.Val().aggregates_));
+      values.emplace_back(column.GetExpr()->EvaluateAggregate(temp.Key().group_bys_, aggregates));
     }
     *tuple = Tuple(values, plan_->OutputSchema());
     return true;
   }
-  return false;
 }
 
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
@@ -0,0 +1,250 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.cpp
+//
+// Identification: src/execution/compiled_predicate.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/expressions/compiled_predicate.h"
+
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the comparison with its operands swapped, e.g. (c < x) for (x > c) */
+auto Flip(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+auto IsCompilableType(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT ||
+         type == TypeId::DECIMAL;
+}
+
+auto ToInt64(const Value &value) -> int64_t {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    default:
+      return value.GetAs<int64_t>();
+  }
+}
+
+auto ToDouble(const Value &value) -> double {
+  return value.GetTypeId() == TypeId::DECIMAL ? value.GetAs<double>() : static_cast<double>(ToInt64(value));
+}
+
+}  // namespace
+
+template <typename T>
+auto CompiledPredicate::Load(const char *data, uint32_t offset) -> T {
+  T value;
+  memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+template <typename T>
+auto CompiledPredicate::IsNullValue(T value) -> bool {
+  if constexpr (std::is_same_v<T, int8_t>) {
+    return value == BUSTUB_INT8_NULL;
+  } else if constexpr (std::is_same_v<T, int16_t>) {
+    return value == BUSTUB_INT16_NULL;
+  } else if constexpr (std::is_same_v<T, int32_t>) {
+    return value == BUSTUB_INT32_NULL;
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return value == BUSTUB_INT64_NULL;
+  } else {
+    return value <= BUSTUB_DECIMAL_NULL;
+  }
+}
+
+template <typename D>
+auto CompiledPredicate::Constant() const -> D {
+  if constexpr (std::is_same_v<D, int64_t>) {
+    return integer_constant_;
+  } else {
+    return decimal_constant_;
+  }
+}
+
+template <typename T, typename D, typename Op>
+auto CompiledPredicate::ColumnConstant(const CompiledPredicate &predicate, const char *data) -> bool {
+  auto value = Load<T>(data, predicate.left_offset_);
+  if (IsNullValue(value)) {
+    return false;
+  }
+  return Op()(static_cast<D>(value), predicate.Constant<D>());
+}
+
+template <typename T, typename Op>
+auto CompiledPredicate::ColumnColumn(const CompiledPredicate &predicate, const char *data) -> bool {
+  auto left = Load<T>(data, predicate.left_offset_);
+  auto right = Load<T>(data, predicate.right_offset_);
+  if (IsNullValue(left) || IsNullValue(right)) {
+    return false;
+  }
+  return Op()(left, right);
+}
+
+auto CompiledPredicate::ConstantResult(const CompiledPredicate &predicate, const char *data) -> bool {
+  return predicate.result_;
+}
+
+template <typename T, typename D>
+auto CompiledPredicate::SelectColumnConstant(ComparisonType comp_type) -> EvalFn {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return &ColumnConstant<T, D, std::equal_to<>>;
+    case ComparisonType::NotEqual:
+      return &ColumnConstant<T, D, std::not_equal_to<>>;
+    case ComparisonType::LessThan:
+      return &ColumnConstant<T, D, std::less<>>;
+    case ComparisonType::LessThanOrEqual:
+      return &ColumnConstant<T, D, std::less_equal<>>;
+    case ComparisonType::GreaterThan:
+      return &ColumnConstant<T, D, std::greater<>>;
+    case ComparisonType::GreaterThanOrEqual:
+      return &ColumnConstant<T, D, std::greater_equal<>>;
+  }
+  return nullptr;
+}
+
+template <typename T>
+auto CompiledPredicate::SelectColumnColumn(ComparisonType comp_type) -> EvalFn {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return &ColumnColumn<T, std::equal_to<>>;
+    case ComparisonType::NotEqual:
+      return &ColumnColumn<T, std::not_equal_to<>>;
+    case ComparisonType::LessThan:
+      return &ColumnColumn<T, std::less<>>;
+    case ComparisonType::LessThanOrEqual:
+      return &ColumnColumn<T, std::less_equal<>>;
+    case ComparisonType::GreaterThan:
+      return &ColumnColumn<T, std::greater<>>;
+    case ComparisonType::GreaterThanOrEqual:
+      return &ColumnColumn<T, std::greater_equal<>>;
+  }
+  return nullptr;
+}
+
+auto CompiledPredicate::Compile(const AbstractExpression *expr, const Schema *schema)
+    -> std::unique_ptr<CompiledPredicate> {
+  std::unique_ptr<CompiledPredicate> predicate(new CompiledPredicate());
+
+  if (auto constant = dynamic_cast<const ConstantValueExpression *>(expr); constant != nullptr) {
+    Value value = constant->Evaluate(nullptr, schema);
+    if (value.GetTypeId() != TypeId::BOOLEAN) {
+      return nullptr;
+    }
+    predicate->result_ = value.GetAs<bool>();
+    predicate->fn_ = &ConstantResult;
+    return predicate;
+  }
+
+  auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return nullptr;
+  }
+  auto comp_type = comparison->GetComparisonType();
+  const AbstractExpression *left = comparison->GetChildAt(0);
+  const AbstractExpression *right = comparison->GetChildAt(1);
+  if (dynamic_cast<const ColumnValueExpression *>(left) == nullptr) {
+    std::swap(left, right);
+    comp_type = Flip(comp_type);
+  }
+  auto left_column = dynamic_cast<const ColumnValueExpression *>(left);
+  if (left_column == nullptr) {
+    return nullptr;
+  }
+  TypeId column_type = schema->GetColumn(left_column->GetColIdx()).GetType();
+  if (!IsCompilableType(column_type)) {
+    return nullptr;
+  }
+  predicate->left_offset_ = schema->GetColumn(left_column->GetColIdx()).GetOffset();
+
+  if (auto right_constant = dynamic_cast<const ConstantValueExpression *>(right); right_constant != nullptr) {
+    Value value = right_constant->Evaluate(nullptr, schema);
+    if (value.IsNull() || !IsCompilableType(value.GetTypeId())) {
+      return nullptr;
+    }
+    bool as_decimal = column_type == TypeId::DECIMAL || value.GetTypeId() == TypeId::DECIMAL;
+    predicate->integer_constant_ = as_decimal ? 0 : ToInt64(value);
+    predicate->decimal_constant_ = ToDouble(value);
+    switch (column_type) {
+      case TypeId::TINYINT:
+        predicate->fn_ = as_decimal ? SelectColumnConstant<int8_t, double>(comp_type)
+                                    : SelectColumnConstant<int8_t, int64_t>(comp_type);
+        break;
+      case TypeId::SMALLINT:
+        predicate->fn_ = as_decimal ? SelectColumnConstant<int16_t, double>(comp_type)
+                                    : SelectColumnConstant<int16_t, int64_t>(comp_type);
+        break;
+      case TypeId::INTEGER:
+        predicate->fn_ = as_decimal ? SelectColumnConstant<int32_t, double>(comp_type)
+                                    : SelectColumnConstant<int32_t, int64_t>(comp_type);
+        break;
+      case TypeId::BIGINT:
+        predicate->fn_ = as_decimal ? SelectColumnConstant<int64_t, double>(comp_type)
+                                    : SelectColumnConstant<int64_t, int64_t>(comp_type);
+        break;
+      default:
+        predicate->fn_ = SelectColumnConstant<double, double>(comp_type);
+        break;
+    }
+    return predicate->fn_ == nullptr ? nullptr : std::move(predicate);
+  }
+
+  auto right_column = dynamic_cast<const ColumnValueExpression *>(right);
+  if (right_column == nullptr || schema->GetColumn(right_column->GetColIdx()).GetType() != column_type) {
+    return nullptr;
+  }
+  predicate->right_offset_ = schema->GetColumn(right_column->GetColIdx()).GetOffset();
+  switch (column_type) {
+    case TypeId::TINYINT:
+      predicate->fn_ = SelectColumnColumn<int8_t>(comp_type);
+      break;
+    case TypeId::SMALLINT:
+      predicate->fn_ = SelectColumnColumn<int16_t>(comp_type);
+      break;
+    case TypeId::INTEGER:
+      predicate->fn_ = SelectColumnColumn<int32_t>(comp_type);
+      break;
+    case TypeId::BIGINT:
+      predicate->fn_ = SelectColumnColumn<int64_t>(comp_type);
+      break;
+    default:
+      predicate->fn_ = SelectColumnColumn<double>(comp_type);
+      break;
+  }
+  return predicate->fn_ == nullptr ? nullptr : std::move(predicate);
+}
+
+}  // namespace bustub
@@ -16,7 +16,7 @@ namespace bustub {
 
 DistinctExecutor::DistinctExecutor(ExecutorContext *exec_ctx, const DistinctPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), set_arena_(exec_ctx->GetArena()) {
   exec_ctx_ = exec_ctx;
   plan_ = plan;
   child_executor_ = std::move(child_executor);
@@ -24,7 +24,8 @@ DistinctExecutor::DistinctExecutor(ExecutorContext *exec_ctx, const DistinctPlan
 
 void DistinctExecutor::Init() {
   child_executor_->Init();
-  set_.clear();
+  set_.Clear();
+  set_arena_.Reset();
 }
 
 auto DistinctExecutor::Next(Tuple *tuple, RID *rid) -> bool {
@@ -33,8 +34,12 @@ auto DistinctExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     for (size_t i = 0; i < plan_->OutputSchema()->GetColumnCount(); i++) {
       key.values_.emplace_back(tuple->GetValue(plan_->OutputSchema(), i));
     }
-    if (set_.count(key) <= 0) {
-      set_.insert(std::move(key));
+    auto hash = std::hash<DistinctKey>()(key);
+    auto make_entry = [this, &key] {
+      set_arena_.Reserve(sizeof(decltype(set_)::Entry) + key.values_.size() * sizeof(Value));
+      return true;
+    };
+    if (set_.FindOrInsert(hash, key, make_entry).second) {
       return true;
     }
   }
@@ -23,9 +23,13 @@
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/limit_executor.h"
+#include "execution/executors/merge_join_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/streaming_aggregation_executor.h"
+#include "execution/executors/topn_executor.h"
 #include "execution/executors/update_executor.h"
 #include "storage/index/generic_key.h"
 
@@ -69,6 +73,12 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
     // Create a new limit executor
     case PlanType::Limit: {
       auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
+      if (limit_plan->GetChildPlan()->GetType() == PlanType::Sort) {
+        // ORDER BY ... LIMIT n only needs the first n tuples of the sort order.
+        auto sort_plan = dynamic_cast<const SortPlanNode *>(limit_plan->GetChildPlan());
+        auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+        return std::make_unique<TopNExecutor>(exec_ctx, limit_plan, sort_plan, std::move(child_executor));
+      }
       auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
       return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
     }
@@ -84,6 +94,9 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
     case PlanType::Aggregation: {
       auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
       auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan());
+      if (StreamingAggregationExecutor::CanStream(agg_plan)) {
+        return std::make_unique<StreamingAggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
+      }
       return std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
     }
 
@@ -111,6 +124,28 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
     }
 
+    // Create a new sort executor
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+
+    // Create a new top-n executor
+    case PlanType::TopN: {
+      auto topn_plan = dynamic_cast<const TopNPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, topn_plan->GetChildPlan());
+      return std::make_unique<TopNExecutor>(exec_ctx, topn_plan, std::move(child_executor));
+    }
+
+    // Create a new merge join executor
+    case PlanType::MergeJoin: {
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan);
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetRightPlan());
+      return std::make_unique<MergeJoinExecutor>(exec_ctx, merge_join_plan, std::move(left), std::move(right));
+    }
+
     default:
       UNREACHABLE("Unsupported plan type.");
   }
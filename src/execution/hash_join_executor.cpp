@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+
 #include "execution/executors/hash_join_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/expressions/column_value_expression.h"
@@ -19,63 +22,487 @@ namespace bustub {
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), table_arena_(exec_ctx->GetArena()) {
   exec_ctx_ = exec_ctx;
   plan_ = plan;
   left_child_executor_ = std::move(left_child);
   right_child_executor_ = std::move(right_child);
-  Tuple left_tuple;
-  RID left_rid;
+}
+
+void HashJoinExecutor::Init() {
   left_child_executor_->Init();
   right_child_executor_->Init();
+  build_partitions_.clear();
+  build_partitions_.resize(NUM_PARTITIONS);
+  build_memory_ = 0;
+  table_arena_.Reset();
+  probing_spilled_ = false;
+  pending_partitions_.clear();
+  current_partition_ = nullptr;
+  hash_table_.Clear();
+  probe_tuples_.clear();
+  probe_tuple_idx_ = 0;
+  next_pos_ = 0;
+  outer_buffer_table_ = nullptr;
+  parallel_ = false;
+  radix_left_ = RadixInput{};
+  radix_right_ = RadixInput{};
+  radix_tables_.clear();
+  probe_batch_ = nullptr;
+  probe_chunk_memory_ = 0;
+  parallel_output_.clear();
+  parallel_output_memory_ = 0;
+  runtime_filter_ = nullptr;
+  output_partition_idx_ = 0;
+  output_tuple_idx_ = 0;
+  if (exec_ctx_->GetParallelism() > 1) {
+    std::vector<Tuple> left_tuples;
+    size_t left_memory = 0;
+    if (MaterializeLeft(&left_tuples, &left_memory)) {
+      ParallelJoin(std::move(left_tuples), left_memory);
+      return;
+    }
+    // too large to join in memory, hand what was read so far to the hybrid hash join
+    table_arena_.Reset();
+    for (const auto &tuple : left_tuples) {
+      AddBuildRow(tuple);
+    }
+  }
+  Build();
+  if (runtime_filter_ == nullptr) {
+    // the left child is empty, so the filter drops every right row
+    runtime_filter_ = std::make_unique<RuntimeFilter>(plan_->RightJoinKeyExpression(), 0);
+  }
+  PushRuntimeFilter();
+}
+
+void HashJoinExecutor::PushRuntimeFilter() {
+  if (!right_child_executor_->PushRuntimeFilter(runtime_filter_.get())) {
+    runtime_filter_ = nullptr;
+  }
+}
+
+auto HashJoinExecutor::PartitionOf(hash_t hash, uint32_t level) -> uint32_t {
+  auto shift = 64 - PARTITION_BITS * (level + 1);
+  return static_cast<uint32_t>(HashUtil::MixHash(hash) >> shift) & (NUM_PARTITIONS - 1);
+}
+
+auto HashJoinExecutor::RowMemory(const Tuple &tuple, uint32_t column_count) -> size_t {
+  return sizeof(std::vector<Value>) + column_count * sizeof(Value) + tuple.GetLength();
+}
+
+auto HashJoinExecutor::LeftKey(const Tuple &tuple) -> HashJoinKey {
+  return {plan_->LeftJoinKeyExpression()->Evaluate(&tuple, plan_->GetLeftPlan()->OutputSchema())};
+}
+
+auto HashJoinExecutor::RightKey(const Tuple &tuple) -> HashJoinKey {
+  return {plan_->RightJoinKeyExpression()->Evaluate(&tuple, plan_->GetRightPlan()->OutputSchema())};
+}
+
+void HashJoinExecutor::InsertBuildRow(JoinHashTable *table, hash_t hash, HashJoinKey &&key, const Tuple &tuple) {
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(left_schema->GetColumnCount());
+  for (uint32_t i = 0; i < left_schema->GetColumnCount(); i++) {
+    values.emplace_back(tuple.GetValue(left_schema, i));
+  }
+  table->FindOrInsert(hash, key, [] { return std::vector<std::vector<Value>>{}; })
+      .first->emplace_back(std::move(values));
+}
+
+void HashJoinExecutor::AddBuildRow(const Tuple &tuple) {
+  HashJoinKey key = LeftKey(tuple);
+  auto hash = std::hash<HashJoinKey>()(key);
+  auto &partition = build_partitions_[PartitionOf(hash, 0)];
+  auto row_memory = RowMemory(tuple, plan_->GetLeftPlan()->OutputSchema()->GetColumnCount());
+  if (runtime_filter_ == nullptr) {
+    // Size the filter for the rows that fit into the budget, so it takes a small share of the budget itself. If the
+    // build side spills, the filter holds more keys than it is sized for and only lets more rows through.
+    auto expected_keys = std::max<size_t>(exec_ctx_->GetMemoryBudget() / row_memory, 1);
+    runtime_filter_ = std::make_unique<RuntimeFilter>(plan_->RightJoinKeyExpression(), expected_keys);
+  }
+  runtime_filter_->Insert(hash);
+  if (partition.spilled_ != nullptr) {
+    partition.spilled_->build_file_->Append(tuple);
+    partition.spilled_->build_memory_ += row_memory;
+    return;
+  }
+  table_arena_.Reserve(row_memory);
+  InsertBuildRow(&partition.table_, hash, std::move(key), tuple);
+  partition.memory_usage_ += row_memory;
+  build_memory_ += row_memory;
+  while (build_memory_ > exec_ctx_->GetMemoryBudget()) {
+    EvictLargestPartition();
+  }
+}
+
+void HashJoinExecutor::Build() {
+  Tuple left_tuple;
+  RID left_rid;
   while (left_child_executor_->Next(&left_tuple, &left_rid)) {
-    Value value = plan_->LeftJoinKeyExpression()->Evaluate(&left_tuple, plan_->GetLeftPlan()->OutputSchema());
-    std::vector<Value> values;
-    HashJoinKey key{value};
-    uint32_t column_count = plan_->GetLeftPlan()->OutputSchema()->GetColumnCount();
-    for (size_t i = 0; i < column_count; i++) {
-      values.emplace_back(left_tuple.GetValue(plan_->GetLeftPlan()->OutputSchema(), i));
+    AddBuildRow(left_tuple);
+  }
+}
+
+auto HashJoinExecutor::MaterializeLeft(std::vector<Tuple> *tuples, size_t *memory) -> bool {
+  uint32_t column_count = plan_->GetLeftPlan()->OutputSchema()->GetColumnCount();
+  Tuple left_tuple;
+  RID left_rid;
+  while (left_child_executor_->Next(&left_tuple, &left_rid)) {
+    auto row_memory = RowMemory(left_tuple, column_count);
+    table_arena_.Reserve(row_memory);
+    *memory += row_memory;
+    tuples->emplace_back(left_tuple);
+    if (*memory > exec_ctx_->GetMemoryBudget()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HashJoinExecutor::ParallelJoin(std::vector<Tuple> &&left_tuples, size_t left_memory) {
+  parallel_ = true;
+  uint32_t num_threads = exec_ctx_->GetParallelism();
+  radix_bits_ = 0;
+  while (radix_bits_ < MAX_RADIX_BITS &&
+         ((left_memory >> radix_bits_) > RADIX_PARTITION_BYTES || (1U << radix_bits_) < num_threads)) {
+    radix_bits_++;
+  }
+  radix_left_.tuples_ = std::move(left_tuples);
+  RadixPartition(&radix_left_, true, radix_bits_, num_threads);
+  runtime_filter_ = std::make_unique<RuntimeFilter>(plan_->RightJoinKeyExpression(), radix_left_.hashes_.size());
+  for (auto hash : radix_left_.hashes_) {
+    runtime_filter_->Insert(hash);
+  }
+  PushRuntimeFilter();
+
+  // build the hash tables of all partitions once, every chunk of the probe side is joined against them
+  size_t num_partitions = size_t{1} << radix_bits_;
+  radix_tables_.resize(num_partitions);
+  std::atomic<size_t> next_partition{0};
+  exec_ctx_->RunParallel(num_threads, [&](uint32_t /* thread_idx */) {
+    for (size_t partition = next_partition++; partition < num_partitions; partition = next_partition++) {
+      size_t begin = radix_left_.offsets_[partition];
+      size_t end = radix_left_.offsets_[partition + 1];
+      auto &table = radix_tables_[partition];
+      table = RadixHashTable(end - begin);
+      for (size_t pos = begin; pos < end; pos++) {
+        auto row = radix_left_.order_[pos];
+        table.FindOrInsert(radix_left_.hashes_[row], radix_left_.keys_[row], [] { return std::vector<uint32_t>{}; })
+            .first->push_back(row);
+      }
+    }
+  });
+
+  // the probe side gets what the build side leaves of the budget, but at least one row per chunk
+  probe_chunk_budget_ = exec_ctx_->GetMemoryBudget() - std::min(exec_ctx_->GetMemoryBudget(), left_memory);
+  probe_batch_ = std::make_unique<TupleBatch>(plan_->GetRightPlan()->OutputSchema());
+  probe_batch_row_ = 0;
+  next_radix_partition_ = num_partitions;
+}
+
+auto HashJoinExecutor::ReadProbeChunk() -> bool {
+  radix_right_ = RadixInput{};
+  table_arena_.Release(probe_chunk_memory_);
+  probe_chunk_memory_ = 0;
+  uint32_t column_count = plan_->GetRightPlan()->OutputSchema()->GetColumnCount();
+  while (radix_right_.tuples_.empty() || probe_chunk_memory_ < probe_chunk_budget_) {
+    if (probe_batch_row_ == probe_batch_->NumSelected()) {
+      // a parallel scan below fills its batches on the scheduler's workers
+      if (!right_child_executor_->NextBatch(probe_batch_.get())) {
+        break;
+      }
+      probe_batch_row_ = 0;
+      continue;
+    }
+    auto tuple = probe_batch_->GetTuple(probe_batch_->SelectedRow(probe_batch_row_++));
+    auto row_memory = RowMemory(tuple, column_count);
+    table_arena_.Reserve(row_memory);
+    probe_chunk_memory_ += row_memory;
+    radix_right_.tuples_.emplace_back(std::move(tuple));
+  }
+  if (radix_right_.tuples_.empty()) {
+    return false;
+  }
+  RadixPartition(&radix_right_, false, radix_bits_, exec_ctx_->GetParallelism());
+  return true;
+}
+
+auto HashJoinExecutor::NextParallelWave() -> bool {
+  size_t num_partitions = radix_tables_.size();
+  if (next_radix_partition_ == num_partitions) {
+    if (!ReadProbeChunk()) {
+      return false;
+    }
+    next_radix_partition_ = 0;
+  }
+  auto first_partition = next_radix_partition_;
+  auto wave_size = static_cast<uint32_t>(
+      std::min<size_t>(exec_ctx_->GetParallelism(), num_partitions - first_partition));
+  parallel_output_.assign(wave_size, {});
+  table_arena_.Release(parallel_output_memory_);
+  parallel_output_memory_ = 0;
+  exec_ctx_->RunParallel(wave_size, [&](uint32_t wave_idx) {
+    JoinRadixPartition(first_partition + wave_idx, &parallel_output_[wave_idx]);
+  });
+  for (const auto &output : parallel_output_) {
+    for (const auto &tuple : output) {
+      parallel_output_memory_ += sizeof(Tuple) + tuple.GetLength();
+    }
+  }
+  table_arena_.Reserve(parallel_output_memory_);
+  next_radix_partition_ += wave_size;
+  output_partition_idx_ = 0;
+  output_tuple_idx_ = 0;
+  return true;
+}
+
+void HashJoinExecutor::RadixPartition(RadixInput *input, bool is_left, uint32_t radix_bits, uint32_t num_threads) {
+  size_t num_rows = input->tuples_.size();
+  size_t num_partitions = size_t{1} << radix_bits;
+  size_t chunk_size = (num_rows + num_threads - 1) / num_threads;
+  input->keys_.resize(num_rows);
+  input->hashes_.resize(num_rows);
+  std::vector<uint32_t> partition_of(num_rows);
+  std::vector<std::vector<size_t>> write_pos(num_threads, std::vector<size_t>(num_partitions, 0));
+
+  // each thread hashes a contiguous chunk of rows and counts the rows of each partition
+  exec_ctx_->RunParallel(num_threads, [&](uint32_t thread_idx) {
+    size_t end = std::min(num_rows, (thread_idx + 1) * chunk_size);
+    for (size_t i = thread_idx * chunk_size; i < end; i++) {
+      input->keys_[i] = is_left ? LeftKey(input->tuples_[i]) : RightKey(input->tuples_[i]);
+      input->hashes_[i] = std::hash<HashJoinKey>()(input->keys_[i]);
+      partition_of[i] =
+          radix_bits == 0 ? 0 : static_cast<uint32_t>(HashUtil::MixHash(input->hashes_[i]) >> (64 - radix_bits));
+      write_pos[thread_idx][partition_of[i]]++;
+    }
+  });
+
+  // turn the counts into the position each thread writes its first row of a partition to
+  input->offsets_.assign(num_partitions + 1, 0);
+  size_t offset = 0;
+  for (size_t partition = 0; partition < num_partitions; partition++) {
+    input->offsets_[partition] = offset;
+    for (uint32_t thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+      auto count = write_pos[thread_idx][partition];
+      write_pos[thread_idx][partition] = offset;
+      offset += count;
+    }
+  }
+  input->offsets_[num_partitions] = offset;
+
+  input->order_.resize(num_rows);
+  exec_ctx_->RunParallel(num_threads, [&](uint32_t thread_idx) {
+    size_t end = std::min(num_rows, (thread_idx + 1) * chunk_size);
+    for (size_t i = thread_idx * chunk_size; i < end; i++) {
+      input->order_[write_pos[thread_idx][partition_of[i]]++] = static_cast<uint32_t>(i);
+    }
+  });
+}
+
+void HashJoinExecutor::JoinRadixPartition(size_t partition, std::vector<Tuple> *out) {
+  const auto &table = radix_tables_[partition];
+  if (table.Size() == 0) {
+    return;
+  }
+  for (size_t pos = radix_right_.offsets_[partition]; pos < radix_right_.offsets_[partition + 1]; pos++) {
+    auto row = radix_right_.order_[pos];
+    auto matches = table.Find(radix_right_.hashes_[row], radix_right_.keys_[row]);
+    if (matches == nullptr) {
+      continue;
+    }
+    for (auto left_row : *matches) {
+      out->emplace_back(MakeOutputTuple(radix_left_.tuples_[left_row], radix_right_.tuples_[row]));
     }
-    if (hash_table_.count(key) > 0) {
-      hash_table_[key].emplace_back(std::move(values));
+  }
+}
+
+auto HashJoinExecutor::MakeOutputTuple(const Tuple &left_tuple, const Tuple &right_tuple) -> Tuple {
+  std::vector<Value> values;
+  values.reserve(plan_->OutputSchema()->GetColumnCount());
+  for (const Column &column : plan_->OutputSchema()->GetColumns()) {
+    auto expr = reinterpret_cast<const ColumnValueExpression *>(column.GetExpr());
+    if (expr->GetTupleIdx() == 0) {
+      values.emplace_back(left_tuple.GetValue(plan_->GetLeftPlan()->OutputSchema(), expr->GetColIdx()));
     } else {
-      hash_table_.insert({key, {values}});
+      values.emplace_back(right_tuple.GetValue(plan_->GetRightPlan()->OutputSchema(), expr->GetColIdx()));
     }
   }
+  return Tuple(values, plan_->OutputSchema());
 }
 
-void HashJoinExecutor::Init() {
-  left_child_executor_->Init();
-  right_child_executor_->Init();
-  next_pos_ = 0;
-  outer_buffer_table_.clear();
+void HashJoinExecutor::EvictLargestPartition() {
+  BuildPartition *victim = nullptr;
+  for (auto &partition : build_partitions_) {
+    if (partition.spilled_ == nullptr && (victim == nullptr || partition.memory_usage_ > victim->memory_usage_)) {
+      victim = &partition;
+    }
+  }
+  victim->spilled_ = MakeSpilledPartition(0);
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  for (size_t i = 0; i < victim->table_.Size(); i++) {
+    for (const auto &row : victim->table_.EntryAt(i).value_) {
+      victim->spilled_->build_file_->Append(Tuple(row, left_schema));
+    }
+  }
+  victim->spilled_->build_memory_ = victim->memory_usage_;
+  build_memory_ -= victim->memory_usage_;
+  table_arena_.Release(victim->memory_usage_);
+  victim->memory_usage_ = 0;
+  victim->table_.Clear();
+}
+
+auto HashJoinExecutor::MakeSpilledPartition(uint32_t level) -> std::unique_ptr<SpilledPartition> {
+  auto partition = std::make_unique<SpilledPartition>();
+  partition->build_file_ = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+  partition->probe_file_ = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+  partition->level_ = level;
+  return partition;
+}
+
+void HashJoinExecutor::LoadSpilledPartition(std::unique_ptr<SpilledPartition> &&partition) {
+  std::vector<Tuple> tuples;
+  if (partition->build_memory_ > exec_ctx_->GetMemoryBudget() && partition->level_ + 1 < MAX_PARTITION_LEVEL) {
+    uint32_t level = partition->level_ + 1;
+    uint32_t column_count = plan_->GetLeftPlan()->OutputSchema()->GetColumnCount();
+    std::vector<std::unique_ptr<SpilledPartition>> children;
+    for (uint32_t i = 0; i < NUM_PARTITIONS; i++) {
+      children.emplace_back(MakeSpilledPartition(level));
+    }
+    for (size_t page_idx = 0; page_idx < partition->build_file_->NumPages(); page_idx++) {
+      partition->build_file_->ReadPage(page_idx, &tuples);
+      for (const auto &tuple : tuples) {
+        auto &child = children[PartitionOf(std::hash<HashJoinKey>()(LeftKey(tuple)), level)];
+        child->build_file_->Append(tuple);
+        child->build_memory_ += RowMemory(tuple, column_count);
+      }
+    }
+    for (size_t page_idx = 0; page_idx < partition->probe_file_->NumPages(); page_idx++) {
+      partition->probe_file_->ReadPage(page_idx, &tuples);
+      for (const auto &tuple : tuples) {
+        auto &child = children[PartitionOf(std::hash<HashJoinKey>()(RightKey(tuple)), level)];
+        if (child->build_file_->Size() > 0) {
+          child->probe_file_->Append(tuple);
+        }
+      }
+    }
+    for (auto &child : children) {
+      if (child->build_file_->Size() > 0 && child->probe_file_->Size() > 0) {
+        child->build_file_->Flush();
+        child->probe_file_->Flush();
+        pending_partitions_.emplace_back(std::move(child));
+      }
+    }
+    return;
+  }
+
+  hash_table_.Clear();
+  table_arena_.Reset();
+  table_arena_.Reserve(partition->build_memory_);
+  for (size_t page_idx = 0; page_idx < partition->build_file_->NumPages(); page_idx++) {
+    partition->build_file_->ReadPage(page_idx, &tuples);
+    for (const auto &tuple : tuples) {
+      HashJoinKey key = LeftKey(tuple);
+      auto hash = std::hash<HashJoinKey>()(key);
+      InsertBuildRow(&hash_table_, hash, std::move(key), tuple);
+    }
+  }
+  current_partition_ = std::move(partition);
+  probe_page_idx_ = 0;
+  probe_tuples_.clear();
+  probe_tuple_idx_ = 0;
+}
+
+auto HashJoinExecutor::NextProbeMatch() -> bool {
+  if (!probing_spilled_) {
+    RID right_rid;
+    while (right_child_executor_->Next(&right_tuple_, &right_rid)) {
+      HashJoinKey key = RightKey(right_tuple_);
+      auto hash = std::hash<HashJoinKey>()(key);
+      auto &partition = build_partitions_[PartitionOf(hash, 0)];
+      if (partition.spilled_ != nullptr) {
+        partition.spilled_->probe_file_->Append(right_tuple_);
+        continue;
+      }
+      outer_buffer_table_ = partition.table_.Find(hash, key);
+      if (outer_buffer_table_ != nullptr) {
+        return true;
+      }
+    }
+    // the resident partitions are done, free them before the spilled ones are loaded
+    for (auto &partition : build_partitions_) {
+      auto &spilled = partition.spilled_;
+      if (spilled != nullptr && spilled->build_file_->Size() > 0 && spilled->probe_file_->Size() > 0) {
+        spilled->build_file_->Flush();
+        spilled->probe_file_->Flush();
+        pending_partitions_.emplace_back(std::move(spilled));
+      }
+    }
+    build_partitions_.clear();
+    build_memory_ = 0;
+    table_arena_.Reset();
+    probing_spilled_ = true;
+  }
+
+  while (true) {
+    while (probe_tuple_idx_ < probe_tuples_.size()) {
+      right_tuple_ = std::move(probe_tuples_[probe_tuple_idx_++]);
+      HashJoinKey key = RightKey(right_tuple_);
+      outer_buffer_table_ = hash_table_.Find(std::hash<HashJoinKey>()(key), key);
+      if (outer_buffer_table_ != nullptr) {
+        return true;
+      }
+    }
+    if (current_partition_ != nullptr && probe_page_idx_ < current_partition_->probe_file_->NumPages()) {
+      current_partition_->probe_file_->ReadPage(probe_page_idx_++, &probe_tuples_);
+      probe_tuple_idx_ = 0;
+      continue;
+    }
+    current_partition_ = nullptr;
+    if (pending_partitions_.empty()) {
+      hash_table_.Clear();
+      table_arena_.Reset();
+      return false;
+    }
+    auto partition = std::move(pending_partitions_.front());
+    pending_partitions_.pop_front();
+    LoadSpilledPartition(std::move(partition));
+  }
 }
 
 auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (next_pos_ >= outer_buffer_table_.size()) {
-    bool is_find = false;
-    while (right_child_executor_->Next(tuple, rid)) {
-
-      Value value = plan_->RightJoinKeyExpression()->Evaluate(tuple, plan_->GetRightPlan()->OutputSchema());
-      HashJoinKey key{value};
-      if (hash_table_.find(key) != hash_table_.end()) {
-        is_find = true;
-        outer_buffer_table_ = hash_table_[key];
-        next_pos_ = 0;
-        break;
+  if (parallel_) {
+    while (true) {
+      while (output_partition_idx_ < parallel_output_.size()) {
+        auto &output = parallel_output_[output_partition_idx_];
+        if (output_tuple_idx_ < output.size()) {
+          *tuple = std::move(output[output_tuple_idx_++]);
+          return true;
+        }
+        // release the partition's output once it has been returned
+        std::vector<Tuple>().swap(output);
+        output_partition_idx_++;
+        output_tuple_idx_ = 0;
+      }
+      if (!NextParallelWave()) {
+        return false;
       }
     }
-    if (!is_find) {
+  }
+  while (outer_buffer_table_ == nullptr || next_pos_ >= outer_buffer_table_->size()) {
+    outer_buffer_table_ = nullptr;
+    if (!NextProbeMatch()) {
       return false;
     }
+    next_pos_ = 0;
   }
   std::vector<Value> values;
   for (const Column &column : plan_->OutputSchema()->GetColumns()) {
     auto expr = reinterpret_cast<const ColumnValueExpression *>(column.GetExpr());
     if (expr->GetTupleIdx() == 0) {
-      values.emplace_back(outer_buffer_table_[next_pos_][expr->GetColIdx()]);
+      values.emplace_back((*outer_buffer_table_)[next_pos_][expr->GetColIdx()]);
     } else {
-      values.emplace_back(tuple->GetValue(plan_->GetRightPlan()->OutputSchema(), expr->GetColIdx()));
+      values.emplace_back(right_tuple_.GetValue(plan_->GetRightPlan()->OutputSchema(), expr->GetColIdx()));
     }
   }
   *tuple = Tuple(values, plan_->OutputSchema());
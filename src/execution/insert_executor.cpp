@@ -32,27 +32,50 @@ void InsertExecutor::Init() {
   next_insert_ = 0;
 }
 
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
-  bool is_insert = false;
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, [[maybe_unused]] RID *rid) -> bool {
+  std::vector<Tuple> tuples;
   if (plan_->IsRawInsert()) {
-    std::vector<std::vector<Value>> raw_vals = plan_->RawValues();
-    if (next_insert_ != raw_vals.size()) {
-      *tuple = Tuple(raw_vals[next_insert_++], &table_info_->schema_);
-      is_insert = table_info_->table_->InsertTuple(*tuple, rid, exec_ctx_->GetTransaction());
+    const auto &raw_vals = plan_->RawValues();
+    while (next_insert_ < raw_vals.size()) {
+      tuples.clear();
+      for (; next_insert_ < raw_vals.size() && tuples.size() < RAW_INSERT_BATCH_SIZE; next_insert_++) {
+        tuples.emplace_back(raw_vals[next_insert_], &table_info_->schema_);
+      }
+      if (!InsertBatch(tuples)) {
+        return false;
+      }
     }
-  } else if (child_executor_->Next(tuple, rid)) {
-    is_insert = table_info_->table_->InsertTuple(*tuple, rid, exec_ctx_->GetTransaction());
+    return false;
   }
 
+  TupleBatch batch(child_executor_->GetOutputSchema());
+  while (child_executor_->NextBatch(&batch)) {
+    tuples.clear();
+    for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+      tuples.push_back(batch.GetTuple(batch.SelectedRow(i)));
+    }
+    if (!InsertBatch(tuples)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+auto InsertExecutor::InsertBatch(const std::vector<Tuple> &tuples) -> bool {
+  // A failed insert leaves the tuples before the failure in the table, so they are indexed like a complete batch
+  bool inserted = table_info_->table_->InsertTuples(tuples, &rids_, exec_ctx_->GetTransaction());
+
   // 插入索引
-  if (is_insert && !index_array_.empty()) {
-    for (auto &index_info : index_array_) {
-      const auto key_tuple =
-          tuple->KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
-      index_info->index_->InsertEntry(key_tuple, *rid, exec_ctx_->GetTransaction());
+  std::vector<std::pair<Tuple, RID>> entries(rids_.size());
+  for (auto &index_info : index_array_) {
+    for (size_t i = 0; i < rids_.size(); i++) {
+      entries[i].first =
+          tuples[i].KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
+      entries[i].second = rids_[i];
     }
+    index_info->index_->InsertEntries(entries, exec_ctx_->GetTransaction());
   }
-  return is_insert;
+  return inserted;
 }
 
 }  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/merge_join_executor.h"
+#include "common/exception.h"
+#include "execution/normalized_key.h"
+
+namespace bustub {
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_child,
+                                     std::unique_ptr<AbstractExecutor> &&right_child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_child)),
+      right_executor_(std::move(right_child)) {}
+
+void MergeJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  left_ = Input{left_executor_.get(), plan_->LeftJoinKeyExpression(), Tuple{}, "", false};
+  right_ = Input{right_executor_.get(), plan_->RightJoinKeyExpression(), Tuple{}, "", false};
+  run_.clear();
+  run_key_.clear();
+  run_pos_ = 0;
+  Advance(&left_);
+  Advance(&right_);
+}
+
+auto MergeJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (true) {
+    if (run_pos_ < run_.size()) {
+      const auto &right_tuple = run_[run_pos_++];
+      std::vector<Value> values;
+      values.reserve(plan_->OutputSchema()->GetColumnCount());
+      for (const Column &column : plan_->OutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateJoin(&left_.tuple_, left_executor_->GetOutputSchema(),
+                                                           &right_tuple, right_executor_->GetOutputSchema()));
+      }
+      *tuple = Tuple(values, plan_->OutputSchema());
+      if (run_pos_ == run_.size()) {
+        // The left tuple has met the whole run, the next left tuple may have the same key.
+        Advance(&left_);
+        if (!left_.exhausted_ && left_.key_ == run_key_) {
+          run_pos_ = 0;
+        }
+      }
+      return true;
+    }
+    if (left_.exhausted_ || right_.exhausted_) {
+      return false;
+    }
+    if (left_.key_ < right_.key_) {
+      Advance(&left_);
+    } else if (right_.key_ < left_.key_) {
+      Advance(&right_);
+    } else {
+      // Buffer the run of right tuples with this key, then join every left tuple of the key with it.
+      run_key_ = right_.key_;
+      run_.clear();
+      while (!right_.exhausted_ && right_.key_ == run_key_) {
+        run_.push_back(right_.tuple_);
+        Advance(&right_);
+      }
+      run_pos_ = 0;
+    }
+  }
+}
+
+void MergeJoinExecutor::Advance(Input *input) {
+  RID rid;
+  while (input->executor_->Next(&input->tuple_, &rid)) {
+    auto key = input->key_expr_->Evaluate(&input->tuple_, input->executor_->GetOutputSchema());
+    if (key.IsNull()) {
+      continue;
+    }
+    std::string normalized_key;
+    NormalizedKey::Append(key, OrderByType::ASC, &normalized_key);
+    if (normalized_key < input->key_) {
+      throw Exception("merge join input is not sorted on its join key");
+    }
+    input->key_ = std::move(normalized_key);
+    return;
+  }
+  input->exhausted_ = true;
+}
+
+}  // namespace bustub
@@ -12,14 +12,171 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include <algorithm>
+#include <numeric>
+
+#include "common/exception.h"
+#include "common/util/hash_util.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/normalized_key.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  auto *catalog = exec_ctx_->GetCatalog();
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  index_info_ = catalog->GetIndex(plan_->GetIndexName(), inner_table_info_->name_);
+  if (index_info_ == Catalog::NULL_INDEX_INFO || index_info_->key_schema_.GetColumnCount() != 1) {
+    throw NotImplementedException("nested index join needs a single column index on the inner table");
+  }
+  auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->Predicate());
+  if (comparison == nullptr || comparison->GetComparisonType() != ComparisonType::Equal) {
+    throw NotImplementedException("nested index join needs an equality predicate");
+  }
+  // The side of the predicate that is a column of the inner table is the one matched by the index
+  auto *inner_column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  bool inner_is_left = inner_column != nullptr && inner_column->GetTupleIdx() == 1;
+  outer_key_expr_ = comparison->GetChildAt(inner_is_left ? 1 : 0);
+}
+
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  outer_batch_.clear();
+  matches_.clear();
+  match_pos_ = 0;
+  inner_rid_ = RID();
+  inner_valid_ = false;
+  runtime_filter_ = nullptr;
+  PushRuntimeFilter();
+  RID rid;
+  has_next_outer_ = child_executor_->Next(&next_outer_tuple_, &rid);
+}
+
+void NestIndexJoinExecutor::PushRuntimeFilter() {
+  auto *inner_heap = inner_table_info_->table_.get();
+  const auto *inner_schema = &inner_table_info_->schema_;
+  auto key_column = index_info_->index_->GetKeyAttrs()[0];
+  // The filter hashes outer keys as they are, so they must not need a cast to the index key type
+  if (outer_key_expr_->GetReturnType() != inner_schema->GetColumn(key_column).GetType() ||
+      inner_heap->GetNumPages() * PAGE_SIZE > exec_ctx_->GetMemoryBudget()) {
+    return;
+  }
+  // Reading the inner table only pays off if the outer side is much larger, which is known for a table scan
+  auto *outer_scan = dynamic_cast<SeqScanExecutor *>(child_executor_.get());
+  if (outer_scan == nullptr || outer_scan->GetNumTablePages() < MIN_OUTER_TO_INNER_PAGES * inner_heap->GetNumPages()) {
+    return;
+  }
+  std::vector<hash_t> key_hashes;
+  auto *txn = exec_ctx_->GetTransaction();
+  for (auto page_id : inner_heap->GetPageIds()) {
+    inner_heap->ScanPage(page_id, txn, [&](const Tuple &tuple) {
+      auto value = tuple.GetValue(inner_schema, key_column);
+      if (!value.IsNull()) {
+        key_hashes.push_back(HashUtil::HashValue(&value));
+      }
+    });
+  }
+  runtime_filter_ = std::make_unique<RuntimeFilter>(outer_key_expr_, key_hashes.size());
+  for (auto hash : key_hashes) {
+    runtime_filter_->Insert(hash);
+  }
+  if (!child_executor_->PushRuntimeFilter(runtime_filter_.get())) {
+    runtime_filter_ = nullptr;
+  }
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto *outer_schema = child_executor_->GetOutputSchema();
+  const auto *inner_schema = &inner_table_info_->schema_;
+  auto *txn = exec_ctx_->GetTransaction();
+  while (true) {
+    while (match_pos_ < matches_.size()) {
+      const auto &match = matches_[match_pos_++];
+      if (!(match.rid_ == inner_rid_)) {
+        inner_rid_ = match.rid_;
+        inner_valid_ = inner_table_info_->table_->GetTuple(inner_rid_, &inner_tuple_, txn);
+      }
+      if (!inner_valid_) {
+        continue;
+      }
+      // The index key may have been cast from the outer value, so the predicate is checked on the actual tuples
+      const auto &outer_tuple = outer_batch_[match.outer_idx_];
+      auto value = plan_->Predicate()->EvaluateJoin(&outer_tuple, outer_schema, &inner_tuple_, inner_schema);
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+      std::vector<Value> values;
+      values.reserve(plan_->OutputSchema()->GetColumnCount());
+      for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateJoin(&outer_tuple, outer_schema, &inner_tuple_, inner_schema));
+      }
+      *tuple = Tuple(values, plan_->OutputSchema());
+      *rid = outer_tuple.GetRid();
+      return true;
+    }
+    if (!NextOuterBatch()) {
+      return false;
+    }
+  }
+}
+
+auto NestIndexJoinExecutor::NextOuterBatch() -> bool {
+  outer_batch_.clear();
+  matches_.clear();
+  match_pos_ = 0;
+  if (!has_next_outer_) {
+    return false;
+  }
+
+  const auto *outer_schema = child_executor_->GetOutputSchema();
+  auto key_type = index_info_->key_schema_.GetColumn(0).GetType();
+  std::vector<Value> key_values;
+  std::vector<std::string> keys;
+  size_t batch_memory = 0;
+  RID rid;
+  while (has_next_outer_ && (outer_batch_.empty() || batch_memory < exec_ctx_->GetMemoryBudget())) {
+    auto value = outer_key_expr_->Evaluate(&next_outer_tuple_, outer_schema);
+    // A NULL key matches nothing
+    if (!value.IsNull()) {
+      if (value.GetTypeId() != key_type) {
+        value = value.CastAs(key_type);
+      }
+      std::string key;
+      NormalizedKey::Append(value, OrderByType::ASC, &key);
+      batch_memory += next_outer_tuple_.GetLength() + key.size() + TUPLE_OVERHEAD;
+      keys.push_back(std::move(key));
+      key_values.push_back(std::move(value));
+      outer_batch_.push_back(next_outer_tuple_);
+    }
+    has_next_outer_ = child_executor_->Next(&next_outer_tuple_, &rid);
+  }
 
-void NestIndexJoinExecutor::Init() {}
+  // Probe the index once per distinct key, in key order
+  std::vector<uint32_t> order(outer_batch_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+  std::vector<RID> rids;
+  auto *txn = exec_ctx_->GetTransaction();
+  for (size_t i = 0; i < order.size(); i++) {
+    if (i == 0 || keys[order[i]] != keys[order[i - 1]]) {
+      rids.clear();
+      Tuple index_key({key_values[order[i]]}, &index_info_->key_schema_);
+      index_info_->index_->ScanKey(index_key, &rids, txn);
+    }
+    for (const auto &inner_rid : rids) {
+      matches_.push_back(Match{inner_rid, order[i]});
+    }
+  }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // Fetch inner tuples in RID order, so each heap page is visited once per batch
+  std::sort(matches_.begin(), matches_.end(), [](const Match &a, const Match &b) {
+    return a.rid_.Get() < b.rid_.Get() || (a.rid_ == b.rid_ && a.outer_idx_ < b.outer_idx_);
+  });
+  return true;
+}
 
 }  // namespace bustub
@@ -23,7 +23,8 @@ NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const
     : AbstractExecutor(exec_ctx),
       plan_(plan),
       left_executor_(std::move(left_executor)),
-      right_executor_(std::move(right_executor)) {
+      right_executor_(std::move(right_executor)),
+      outer_arena_(exec_ctx->GetArena()) {
   if (plan_->Predicate() != nullptr) {
     predicate_ = plan_->Predicate();
   } else {
@@ -40,42 +41,75 @@ NestedLoopJoinExecutor::~NestedLoopJoinExecutor() {
 }
 void NestedLoopJoinExecutor::Init() {
   left_executor_->Init();
-  right_executor_->Init();
-  is_selected_ = left_executor_->Next(&left_tuple_, &left_rid_);
+  outer_batch_.clear();
+  has_inner_ = false;
+  num_inner_scans_ = 0;
+  RID rid;
+  has_next_outer_ = left_executor_->Next(&next_outer_tuple_, &rid);
+  NextOuterBatch();
 }
 
 auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (!is_selected_) {
+  const auto *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const auto *right_schema = plan_->GetRightPlan()->OutputSchema();
+  if (outer_batch_.empty()) {
+    // the outer child is exhausted, and the inner child is only initialized for a batch of outer tuples
     return false;
   }
-  Tuple right_tuple;
-  RID right_rid;
   while (true) {
-    while (!right_executor_->Next(&right_tuple, &right_rid)) {
-      if (!left_executor_->Next(&left_tuple_, &left_rid_)) {
-        return false;
+    if (!has_inner_) {
+      RID right_rid;
+      while (!right_executor_->Next(&inner_tuple_, &right_rid)) {
+        if (!NextOuterBatch()) {
+          return false;
+        }
       }
-      right_executor_->Init();
+      has_inner_ = true;
+      outer_pos_ = 0;
     }
-    auto value = predicate_->EvaluateJoin(&left_tuple_, plan_->GetLeftPlan()->OutputSchema(), &right_tuple,
-                                          plan_->GetRightPlan()->OutputSchema());
-    if (value.GetAs<bool>()) {
+    while (outer_pos_ < outer_batch_.size()) {
+      const auto &left_tuple = outer_batch_[outer_pos_++];
+      auto value = predicate_->EvaluateJoin(&left_tuple, left_schema, &inner_tuple_, right_schema);
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
       std::vector<Value> values;
       values.reserve(plan_->OutputSchema()->GetColumnCount());
       for (const auto &column : plan_->OutputSchema()->GetColumns()) {
         auto expr = reinterpret_cast<const ColumnValueExpression *>(column.GetExpr());
         if (expr->GetTupleIdx() == 0) {
-          values.emplace_back(left_tuple_.GetValue(plan_->GetLeftPlan()->OutputSchema(), expr->GetColIdx()));
+          values.emplace_back(left_tuple.GetValue(left_schema, expr->GetColIdx()));
         } else {
-          values.emplace_back(right_tuple.GetValue(plan_->GetRightPlan()->OutputSchema(), expr->GetColIdx()));
+          values.emplace_back(inner_tuple_.GetValue(right_schema, expr->GetColIdx()));
         }
       }
       *tuple = Tuple(values, plan_->OutputSchema());
-      *rid = left_tuple_.GetRid();
+      *rid = left_tuple.GetRid();
       return true;
     }
+    has_inner_ = false;
   }
-  return false;
+}
+
+auto NestedLoopJoinExecutor::NextOuterBatch() -> bool {
+  outer_batch_.clear();
+  outer_arena_.Reset();
+  if (!has_next_outer_) {
+    return false;
+  }
+  // A batch always holds at least one tuple, however small the budget
+  size_t batch_memory = 0;
+  RID rid;
+  while (has_next_outer_ && (outer_batch_.empty() || batch_memory < exec_ctx_->GetMemoryBudget())) {
+    batch_memory += next_outer_tuple_.GetLength() + TUPLE_OVERHEAD;
+    auto length = next_outer_tuple_.GetLength();
+    outer_batch_.push_back(
+        Tuple::View(outer_arena_.Copy(next_outer_tuple_.GetData(), length), length, next_outer_tuple_.GetRid()));
+    has_next_outer_ = left_executor_->Next(&next_outer_tuple_, &rid);
+  }
+  right_executor_->Init();
+  num_inner_scans_++;
+  return true;
 }
 
 }  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.cpp
+//
+// Identification: src/execution/normalized_key.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "execution/normalized_key.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr char NULL_MARKER = 0x00;
+constexpr char VALUE_MARKER = 0x01;
+
+/** Appends an unsigned integer in big-endian byte order, so memcmp orders it numerically. */
+void AppendBigEndian(uint64_t bits, std::string *key) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key->push_back(static_cast<char>((bits >> shift) & 0xff));
+  }
+}
+
+}  // namespace
+
+void NormalizedKey::Append(const Value &value, OrderByType order_by_type, std::string *key) {
+  auto begin = key->size();
+  if (value.IsNull()) {
+    key->push_back(NULL_MARKER);
+  } else {
+    key->push_back(VALUE_MARKER);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendBigEndian(static_cast<uint64_t>(int64_t{value.GetAs<int8_t>()}) ^ (uint64_t{1} << 63), key);
+        break;
+      case TypeId::SMALLINT:
+        AppendBigEndian(static_cast<uint64_t>(int64_t{value.GetAs<int16_t>()}) ^ (uint64_t{1} << 63), key);
+        break;
+      case TypeId::INTEGER:
+        AppendBigEndian(static_cast<uint64_t>(int64_t{value.GetAs<int32_t>()}) ^ (uint64_t{1} << 63), key);
+        break;
+      case TypeId::BIGINT:
+        // Flipping the sign bit maps two's complement order onto unsigned order.
+        AppendBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (uint64_t{1} << 63), key);
+        break;
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>(), key);
+        break;
+      case TypeId::DECIMAL: {
+        // Negative doubles order in reverse of their bits, so all of their bits are flipped; positive ones only
+        // need the sign bit set to sort above the negative ones.
+        auto decimal = value.GetAs<double>();
+        uint64_t bits;
+        std::memcpy(&bits, &decimal, sizeof(bits));
+        AppendBigEndian((bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63), key);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        // Zero bytes are escaped as {0x00, 0xff} and the string ends with {0x00, 0x00}, so a string sorts before
+        // every string it is a prefix of and the encoding of the next key cannot change the order.
+        const char *data = value.GetData();
+        uint32_t length = value.GetLength();
+        if (length > 0 && data[length - 1] == '\0') {
+          length--;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+          key->push_back(data[i]);
+          if (data[i] == '\0') {
+            key->push_back(static_cast<char>(0xff));
+          }
+        }
+        key->push_back('\0');
+        key->push_back('\0');
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  if (order_by_type == OrderByType::DESC) {
+    for (auto i = begin; i < key->size(); i++) {
+      (*key)[i] = static_cast<char>(~(*key)[i]);
+    }
+  }
+}
+
+auto NormalizedKey::Encode(const Tuple &tuple, const Schema *schema,
+                           const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys)
+    -> std::string {
+  std::string key;
+  for (const auto &[order_by_type, expr] : order_bys) {
+    Append(expr->Evaluate(&tuple, schema), order_by_type, &key);
+  }
+  return key;
+}
+
+}  // namespace bustub
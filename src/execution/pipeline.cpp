@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline.cpp
+//
+// Identification: src/execution/pipeline.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/pipeline.h"
+
+#include "execution/expressions/column_value_expression.h"
+
+namespace bustub {
+
+void Pipeline::Run() {
+  auto num_threads = source_->GetNumThreads();
+  for (auto *op = head_; op != nullptr; op = op->GetNext()) {
+    op->Open(num_threads);
+  }
+  source_->Produce(head_);
+  for (auto *op = head_; op != nullptr; op = op->GetNext()) {
+    op->Close();
+  }
+}
+
+void ScanSource::Produce(PushOperator *target) {
+  scan_->Init();
+  if (scan_->UseParallelScan()) {
+    scan_->ParallelScan(GetNumThreads(), [&](uint32_t thread_idx, const TupleBatch &batch) {
+      if (target->IsDone()) {
+        scan_->CancelParallelScan();
+        return;
+      }
+      target->Consume(thread_idx, batch);
+    });
+    return;
+  }
+  TupleBatch batch(scan_->GetOutputSchema());
+  while (!target->IsDone() && scan_->NextBatch(&batch)) {
+    target->Consume(0, batch);
+  }
+}
+
+auto ScanSource::GetNumThreads() const -> uint32_t {
+  return scan_->UseParallelScan() ? scan_->GetExecutorContext()->GetParallelism() : 1;
+}
+
+void ExecutorSource::Produce(PushOperator *target) {
+  executor_->Init();
+  TupleBatch batch(executor_->GetOutputSchema());
+  while (!target->IsDone() && executor_->NextBatch(&batch)) {
+    target->Consume(0, batch);
+  }
+}
+
+void HashBuildSink::Open(uint32_t num_threads) {
+  local_rows_.clear();
+  local_rows_.resize(num_threads);
+  table_.Clear();
+  local_arenas_.clear();
+  for (uint32_t i = 0; i < num_threads; i++) {
+    local_arenas_.push_back(std::make_unique<Arena>(arena_));
+  }
+}
+
+void HashBuildSink::Consume(uint32_t thread_idx, const TupleBatch &batch) {
+  auto &rows = local_rows_[thread_idx];
+  auto column_count = batch.GetSchema()->GetColumnCount();
+  local_arenas_[thread_idx]->Reserve(batch.NumSelected() * (sizeof(BuildRow) + column_count * sizeof(Value)));
+  for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+    auto row = batch.SelectedRow(i);
+    HashJoinKey key{plan_->LeftJoinKeyExpression()->EvaluateBatchRow(&batch, row)};
+    auto hash = std::hash<HashJoinKey>()(key);
+    std::vector<Value> values;
+    values.reserve(column_count);
+    for (uint32_t col = 0; col < column_count; col++) {
+      values.push_back(batch.GetValue(col, row));
+    }
+    rows.push_back(BuildRow{hash, std::move(key), std::move(values)});
+  }
+}
+
+void HashBuildSink::Close() {
+  for (auto &rows : local_rows_) {
+    for (auto &row : rows) {
+      auto [matches, inserted] =
+          table_.FindOrInsert(row.hash_, row.key_, []() { return std::vector<std::vector<Value>>{}; });
+      matches->push_back(std::move(row.values_));
+    }
+    rows.clear();
+  }
+}
+
+auto HashProbeOperator::CanProbe(const HashJoinPlanNode *plan) -> bool {
+  for (const auto &column : plan->OutputSchema()->GetColumns()) {
+    if (dynamic_cast<const ColumnValueExpression *>(column.GetExpr()) == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HashProbeOperator::Open(uint32_t num_threads) {
+  outputs_.clear();
+  for (uint32_t i = 0; i < num_threads; i++) {
+    outputs_.push_back(std::make_unique<TupleBatch>(plan_->OutputSchema()));
+  }
+}
+
+void HashProbeOperator::Consume(uint32_t thread_idx, const TupleBatch &batch) {
+  auto &output = *outputs_[thread_idx];
+  const auto &columns = plan_->OutputSchema()->GetColumns();
+  // The table is only read while probing, so the threads share it without synchronization.
+  const auto &table = build_->GetTable();
+  for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+    auto row = batch.SelectedRow(i);
+    HashJoinKey key{plan_->RightJoinKeyExpression()->EvaluateBatchRow(&batch, row)};
+    const auto *matches = table.Find(std::hash<HashJoinKey>()(key), key);
+    if (matches == nullptr) {
+      continue;
+    }
+    for (const auto &build_values : *matches) {
+      for (uint32_t col = 0; col < columns.size(); col++) {
+        auto expr = static_cast<const ColumnValueExpression *>(columns[col].GetExpr());
+        output.GetColumn(col).Append(expr->GetTupleIdx() == 0 ? build_values[expr->GetColIdx()]
+                                                              : batch.GetValue(expr->GetColIdx(), row));
+      }
+      output.CommitRow(batch.GetRID(row));
+      if (output.IsFull()) {
+        next_->Consume(thread_idx, output);
+        output.Reset();
+      }
+    }
+  }
+  if (output.NumRows() > 0) {
+    next_->Consume(thread_idx, output);
+    output.Reset();
+  }
+}
+
+void AggregationSink::Open(uint32_t num_threads) {
+  tables_.clear();
+  for (uint32_t i = 0; i < num_threads; i++) {
+    tables_.push_back(
+        std::make_unique<SimpleAggregationHashTable>(plan_->GetAggregates(), plan_->GetAggregateTypes(), arena_));
+  }
+}
+
+void AggregationSink::Consume(uint32_t thread_idx, const TupleBatch &batch) {
+  auto &table = *tables_[thread_idx];
+  std::vector<Value> keys;
+  for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+    auto row = batch.SelectedRow(i);
+    keys.clear();
+    for (const auto &expr : plan_->GetGroupBys()) {
+      keys.emplace_back(expr->EvaluateBatchRow(&batch, row));
+    }
+    AggregateKey key{keys};
+    table.InsertCombine(std::hash<AggregateKey>()(key), key, batch, row);
+  }
+}
+
+void AggregationSink::Close() {
+  for (size_t i = 1; i < tables_.size(); i++) {
+    tables_[0]->Merge(*tables_[i]);
+  }
+  tables_.resize(1);
+}
+
+void AggregationSource::Produce(PushOperator *target) {
+  const auto *plan = sink_->GetPlan();
+  auto *table = sink_->GetTable();
+  const auto *having = plan->GetHaving();
+  TupleBatch output(plan->OutputSchema());
+  for (auto iter = table->Begin(); iter != table->End() && !target->IsDone(); ++iter) {
+    auto aggregates = iter.Val().aggregates_;
+    const auto &group_bys = iter.Key().group_bys_;
+    if (having != nullptr && !having->EvaluateAggregate(group_bys, aggregates).GetAs<bool>()) {
+      continue;
+    }
+    const auto &columns = plan->OutputSchema()->GetColumns();
+    for (uint32_t col = 0; col < columns.size(); col++) {
+      output.GetColumn(col).Append(columns[col].GetExpr()->EvaluateAggregate(group_bys, aggregates));
+    }
+    output.CommitRow(RID());
+    if (output.IsFull()) {
+      target->Consume(0, output);
+      output.Reset();
+    }
+  }
+  if (output.NumRows() > 0 && !target->IsDone()) {
+    target->Consume(0, output);
+  }
+}
+
+void LimitOperator::Consume(uint32_t thread_idx, const TupleBatch &batch) {
+  // Claim rows for this batch; threads racing past the limit get fewer or none.
+  size_t claimed = count_.fetch_add(batch.NumSelected());
+  if (claimed >= limit_) {
+    return;
+  }
+  if (claimed + batch.NumSelected() <= limit_) {
+    next_->Consume(thread_idx, batch);
+    return;
+  }
+  TupleBatch limited = batch;
+  std::vector<uint32_t> selection;
+  for (uint32_t i = 0; i < limit_ - claimed; i++) {
+    selection.push_back(batch.SelectedRow(i));
+  }
+  limited.SetSelection(std::move(selection));
+  next_->Consume(thread_idx, limited);
+}
+
+void ResultSink::Open(uint32_t num_threads) {
+  local_results_.clear();
+  local_results_.resize(num_threads);
+}
+
+void ResultSink::Consume(uint32_t thread_idx, const TupleBatch &batch) {
+  if (result_set_ == nullptr) {
+    return;
+  }
+  auto &results = local_results_[thread_idx];
+  for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+    results.push_back(batch.GetTuple(batch.SelectedRow(i)));
+  }
+}
+
+void ResultSink::Close() {
+  if (result_set_ == nullptr) {
+    return;
+  }
+  for (auto &results : local_results_) {
+    result_set_->insert(result_set_->end(), std::make_move_iterator(results.begin()),
+                        std::make_move_iterator(results.end()));
+    results.clear();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_execution_engine.cpp
+//
+// Identification: src/execution/pipeline_execution_engine.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/pipeline_execution_engine.h"
+
+#include "execution/executor_factory.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+
+namespace bustub {
+
+auto PipelineExecutionEngine::Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
+                                      ExecutorContext *exec_ctx) -> bool {
+  exec_ctx->GetArena()->ResetPeak();
+  bool success = true;
+  {
+    QueryPipelines query;
+    try {
+      if (plan->OutputSchema() == nullptr) {
+        // Plans without output rows (e.g. insert) have nothing to push
+        auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
+        executor->Init();
+        Tuple tuple;
+        RID rid;
+        while (!exec_ctx->IsCancelled() && executor->Next(&tuple, &rid)) {
+        }
+      } else {
+        auto sink = std::make_unique<ResultSink>(result_set);
+        BuildPipelines(plan, sink.get(), exec_ctx, &query);
+        query.operators_.push_back(std::move(sink));
+        for (auto &pipeline : query.pipelines_) {
+          if (exec_ctx->IsCancelled()) {
+            break;
+          }
+          pipeline.Run();
+        }
+      }
+    } catch (Exception &e) {
+      success = false;
+    }
+  }
+  // The result tuples own their data, so everything the query allocated can go at once
+  exec_ctx->GetArena()->Reset();
+  return success && !exec_ctx->IsCancelled();
+}
+
+void PipelineExecutionEngine::BuildPipelines(const AbstractPlanNode *plan, PushOperator *consumer,
+                                             ExecutorContext *exec_ctx, QueryPipelines *query) {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      auto scan = std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan));
+      query->sources_.push_back(std::make_unique<ScanSource>(std::move(scan)));
+      query->pipelines_.emplace_back(query->sources_.back().get(), consumer);
+      return;
+    }
+
+    case PlanType::HashJoin: {
+      auto join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      if (!HashProbeOperator::CanProbe(join_plan)) {
+        break;
+      }
+      // The build pipeline has to finish before the probe pipeline starts
+      auto build = std::make_unique<HashBuildSink>(join_plan, exec_ctx->GetArena());
+      BuildPipelines(join_plan->GetLeftPlan(), build.get(), exec_ctx, query);
+      auto probe = std::make_unique<HashProbeOperator>(join_plan, build.get());
+      probe->SetNext(consumer);
+      BuildPipelines(join_plan->GetRightPlan(), probe.get(), exec_ctx, query);
+      query->operators_.push_back(std::move(build));
+      query->operators_.push_back(std::move(probe));
+      return;
+    }
+
+    case PlanType::Aggregation: {
+      auto aggregation_plan = dynamic_cast<const AggregationPlanNode *>(plan);
+      auto sink = std::make_unique<AggregationSink>(aggregation_plan, exec_ctx->GetArena());
+      BuildPipelines(aggregation_plan->GetChildPlan(), sink.get(), exec_ctx, query);
+      query->sources_.push_back(std::make_unique<AggregationSource>(sink.get()));
+      query->pipelines_.emplace_back(query->sources_.back().get(), consumer);
+      query->operators_.push_back(std::move(sink));
+      return;
+    }
+
+    case PlanType::Limit: {
+      auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
+      auto limit = std::make_unique<LimitOperator>(limit_plan->GetLimit());
+      limit->SetNext(consumer);
+      BuildPipelines(limit_plan->GetChildPlan(), limit.get(), exec_ctx, query);
+      query->operators_.push_back(std::move(limit));
+      return;
+    }
+
+    default:
+      break;
+  }
+  // Everything else is pulled from an executor tree
+  query->sources_.push_back(std::make_unique<ExecutorSource>(ExecutorFactory::CreateExecutor(exec_ctx, plan)));
+  query->pipelines_.emplace_back(query->sources_.back().get(), consumer);
+}
+
+}  // namespace bustub
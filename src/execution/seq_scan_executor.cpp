@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/seq_scan_executor.h"
+#include "common/exception.h"
+#include "execution/morsel_dispenser.h"
+#include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
 #include "type/value_factory.h"
@@ -18,13 +21,14 @@
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), iter_(nullptr, RID{}, nullptr) {
+    : AbstractExecutor(exec_ctx), iter_(nullptr, RID{}, nullptr), current_batch_(plan->OutputSchema()) {
   plan_ = plan;
   exec_ctx_ = exec_ctx;
   table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
 }
 
 SeqScanExecutor::~SeqScanExecutor() {
+  StopParallelScan();
   if (is_alloc_) {
     delete predicate_;
   }
@@ -32,32 +36,231 @@ SeqScanExecutor::~SeqScanExecutor() {
 }
 
 void SeqScanExecutor::Init() {
+  StopParallelScan();
   iter_ = table_info_->table_->Begin(exec_ctx_->GetTransaction());
+  runtime_filters_.clear();
   if (plan_->GetPredicate() != nullptr) {
     predicate_ = plan_->GetPredicate();
-  } else {
+  } else if (!is_alloc_) {
     is_alloc_ = true;
     predicate_ = new ConstantValueExpression(ValueFactory::GetBooleanValue(true));
   }
+  compiled_predicate_ = CompiledPredicate::Compile(predicate_, &table_info_->schema_);
+
+  const Schema *schema = plan_->OutputSchema();
+  const Schema &table_schema = table_info_->schema_;
+  identity_projection_ = schema->GetColumnCount() == table_schema.GetColumnCount();
+  for (uint32_t i = 0; identity_projection_ && i < schema->GetColumnCount(); i++) {
+    auto column_expr = dynamic_cast<const ColumnValueExpression *>(schema->GetColumn(i).GetExpr());
+    identity_projection_ = column_expr != nullptr && column_expr->GetColIdx() == i &&
+                           schema->GetColumn(i).GetType() == table_schema.GetColumn(i).GetType();
+  }
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  while(iter_ != table_info_->table_->End()) {
-    auto temp = iter_++;
-    const Schema *schema = plan_->OutputSchema();
-    auto value = predicate_->Evaluate(&(*temp), &table_info_->schema_);
-    if (value.GetAs<bool>()) {
+  if (UseParallelScan()) {
+    while (current_row_ >= current_batch_.NumSelected()) {
+      current_row_ = 0;
+      if (!PopExchangeBatch(&current_batch_)) {
+        return false;
+      }
+    }
+    auto row = current_batch_.SelectedRow(current_row_++);
+    *tuple = current_batch_.GetTuple(row);
+    *rid = current_batch_.GetRID(row);
+    return true;
+  }
+  const Schema *schema = plan_->OutputSchema();
+  for (; iter_ != table_info_->table_->End(); ++iter_) {
+    const Tuple &table_tuple = *iter_;
+    if (!MatchesPredicate(table_tuple) || !PassesRuntimeFilters(table_tuple)) {
+      continue;
+    }
+    if (identity_projection_) {
+      *tuple = table_tuple;
+    } else {
       std::vector<Value> values;
       values.reserve(schema->GetColumnCount());
       for (const Column &column : schema->GetColumns()) {
-        values.push_back(column.GetExpr()->Evaluate(&(*temp), &table_info_->schema_));
+        values.push_back(column.GetExpr()->Evaluate(&table_tuple, &table_info_->schema_));
       }
       *tuple = Tuple(values, schema);
-      *rid = temp->GetRid();
-      return true;
     }
+    *rid = table_tuple.GetRid();
+    ++iter_;
+    return true;
   }
   return false;
 }
 
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (UseParallelScan()) {
+    return PopExchangeBatch(batch);
+  }
+  batch->Reset();
+  while (!batch->IsFull() && iter_ != table_info_->table_->End()) {
+    const Tuple &table_tuple = *iter_;
+    if (MatchesPredicate(table_tuple)) {
+      AppendOutputRow(table_tuple, batch);
+    }
+    ++iter_;
+  }
+  ApplyRuntimeFilters(batch);
+  return batch->NumRows() > 0;
+}
+
+void SeqScanExecutor::ParallelScan(uint32_t num_threads,
+                                   const std::function<void(uint32_t, const TupleBatch &)> &sink) {
+  MorselDispenser dispenser(table_info_->table_->GetPageIds());
+  std::atomic<bool> page_missing{false};
+  exec_ctx_->RunParallel(num_threads, [&](uint32_t thread_idx) {
+    TupleBatch batch(plan_->OutputSchema());
+    // Batches filled while a page is latched are handed to the sink only after the page is released
+    std::vector<TupleBatch> full_batches;
+    auto emit = [&](TupleBatch *out) {
+      ApplyRuntimeFilters(out);
+      if (out->NumSelected() > 0) {
+        sink(thread_idx, *out);
+      }
+    };
+    auto visit = [&](const Tuple &table_tuple) {
+      if (MatchesPredicate(table_tuple)) {
+        AppendOutputRow(table_tuple, &batch);
+        if (batch.IsFull()) {
+          full_batches.push_back(std::move(batch));
+          batch = TupleBatch(plan_->OutputSchema());
+        }
+      }
+    };
+    size_t begin;
+    size_t end;
+    while (!cancelled_ && !exec_ctx_->IsCancelled() && dispenser.Next(&begin, &end)) {
+      for (size_t page_idx = begin; page_idx < end; page_idx++) {
+        if (!table_info_->table_->ScanPage(dispenser.GetPageId(page_idx), exec_ctx_->GetTransaction(), visit)) {
+          page_missing = true;
+          cancelled_ = true;
+          break;
+        }
+        for (auto &full_batch : full_batches) {
+          emit(&full_batch);
+        }
+        full_batches.clear();
+      }
+    }
+    emit(&batch);
+  });
+  if (page_missing) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "parallel scan could not fetch a table page");
+  }
+}
+
+auto SeqScanExecutor::PushRuntimeFilter(RuntimeFilter *filter) -> bool {
+  auto key_expr = dynamic_cast<const ColumnValueExpression *>(filter->GetKeyExpression());
+  if (key_expr == nullptr || key_expr->GetColIdx() >= plan_->OutputSchema()->GetColumnCount()) {
+    return false;
+  }
+  runtime_filters_.emplace_back(filter, plan_->OutputSchema()->GetColumn(key_expr->GetColIdx()).GetExpr());
+  return true;
+}
+
+auto SeqScanExecutor::UseParallelScan() const -> bool {
+  // Row locks are taken through the transaction, which is not safe to share between threads.
+  return exec_ctx_->GetParallelism() > 1 && !enable_logging;
+}
+
+void SeqScanExecutor::AppendOutputRow(const Tuple &table_tuple, TupleBatch *batch) {
+  const Schema *schema = plan_->OutputSchema();
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    batch->GetColumn(i).Append(schema->GetColumn(i).GetExpr()->Evaluate(&table_tuple, &table_info_->schema_));
+  }
+  batch->CommitRow(table_tuple.GetRid());
+}
+
+void SeqScanExecutor::ApplyRuntimeFilters(TupleBatch *batch) {
+  for (auto &runtime_filter : runtime_filters_) {
+    RuntimeFilter *filter = runtime_filter.first;
+    std::vector<uint32_t> selection;
+    selection.reserve(batch->NumSelected());
+    for (uint32_t i = 0; i < batch->NumSelected(); i++) {
+      auto row = batch->SelectedRow(i);
+      if (filter->Check(filter->GetKeyExpression()->EvaluateBatchRow(batch, row))) {
+        selection.push_back(row);
+      }
+    }
+    batch->SetSelection(std::move(selection));
+  }
+}
+
+auto SeqScanExecutor::PopExchangeBatch(TupleBatch *batch) -> bool {
+  if (!producer_.joinable()) {
+    producer_ = std::thread([this]() {
+      try {
+        ParallelScan(exec_ctx_->GetParallelism(), [this](uint32_t /* thread_idx */, const TupleBatch &produced) {
+          PushExchangeBatch(produced);
+        });
+      } catch (...) {
+        producer_error_ = std::current_exception();
+      }
+      std::scoped_lock lock{exchange_latch_};
+      producer_done_ = true;
+      exchange_not_empty_.notify_all();
+    });
+  }
+  std::unique_lock lock{exchange_latch_};
+  exchange_not_empty_.wait(lock, [this]() { return !exchange_.empty() || producer_done_; });
+  if (exchange_.empty()) {
+    if (producer_error_ != nullptr) {
+      std::rethrow_exception(producer_error_);
+    }
+    return false;
+  }
+  *batch = std::move(exchange_.front());
+  exchange_.pop_front();
+  exchange_not_full_.notify_one();
+  return true;
+}
+
+void SeqScanExecutor::PushExchangeBatch(const TupleBatch &batch) {
+  std::unique_lock lock{exchange_latch_};
+  exchange_not_full_.wait(lock, [this]() { return exchange_.size() < MAX_EXCHANGE_BATCHES || cancelled_; });
+  if (cancelled_) {
+    return;
+  }
+  exchange_.push_back(batch);
+  exchange_not_empty_.notify_one();
+}
+
+void SeqScanExecutor::StopParallelScan() {
+  if (producer_.joinable()) {
+    {
+      std::scoped_lock lock{exchange_latch_};
+      cancelled_ = true;
+    }
+    exchange_not_full_.notify_all();
+    producer_.join();
+  }
+  exchange_.clear();
+  producer_done_ = false;
+  producer_error_ = nullptr;
+  cancelled_ = false;
+  current_batch_.Reset();
+  current_row_ = 0;
+}
+
+auto SeqScanExecutor::MatchesPredicate(const Tuple &table_tuple) -> bool {
+  if (compiled_predicate_ != nullptr) {
+    return compiled_predicate_->Evaluate(table_tuple);
+  }
+  return predicate_->Evaluate(&table_tuple, &table_info_->schema_).GetAs<bool>();
+}
+
+auto SeqScanExecutor::PassesRuntimeFilters(const Tuple &table_tuple) -> bool {
+  for (auto &[filter, key_expr] : runtime_filters_) {
+    if (!filter->Check(key_expr->Evaluate(&table_tuple, &table_info_->schema_))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace bustub
@@ -0,0 +1,214 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "execution/executors/sort_executor.h"
+#include "execution/normalized_key.h"
+
+namespace bustub {
+
+namespace {
+
+/*
+ * Tuples are written to runs together with their keys, so merging never evaluates a key again. A run tuple holds
+ * | key size (4 bytes) | normalized key | data of the sorted tuple |.
+ */
+
+/** @return a run tuple holding the key and the tuple */
+auto MakeRunTuple(std::string_view key, const Tuple &tuple) -> Tuple {
+  auto key_size = static_cast<uint32_t>(key.size());
+  uint32_t size = sizeof(uint32_t) + key_size + tuple.GetLength();
+  std::vector<char> storage(sizeof(uint32_t) + size);
+  std::memcpy(storage.data(), &size, sizeof(uint32_t));
+  std::memcpy(storage.data() + sizeof(uint32_t), &key_size, sizeof(uint32_t));
+  std::memcpy(storage.data() + 2 * sizeof(uint32_t), key.data(), key_size);
+  std::memcpy(storage.data() + 2 * sizeof(uint32_t) + key_size, tuple.GetData(), tuple.GetLength());
+  Tuple run_tuple;
+  run_tuple.DeserializeFrom(storage.data());
+  return run_tuple;
+}
+
+/** @return the key of a run tuple */
+auto RunTupleKey(const Tuple &run_tuple) -> std::string_view {
+  uint32_t key_size;
+  std::memcpy(&key_size, run_tuple.GetData(), sizeof(uint32_t));
+  return {run_tuple.GetData() + sizeof(uint32_t), key_size};
+}
+
+/** @return the sorted tuple of a run tuple */
+auto RunTuplePayload(const Tuple &run_tuple) -> Tuple {
+  auto key_size = static_cast<uint32_t>(RunTupleKey(run_tuple).size());
+  uint32_t size = run_tuple.GetLength() - sizeof(uint32_t) - key_size;
+  std::vector<char> storage(sizeof(uint32_t) + size);
+  std::memcpy(storage.data(), &size, sizeof(uint32_t));
+  std::memcpy(storage.data() + sizeof(uint32_t), run_tuple.GetData() + sizeof(uint32_t) + key_size, size);
+  Tuple tuple;
+  tuple.DeserializeFrom(storage.data());
+  return tuple;
+}
+
+}  // namespace
+
+void SortExecutor::RunCursor::Advance() {
+  pos_++;
+  if (pos_ == page_.size() && page_idx_ + 1 < run_->NumPages()) {
+    run_->ReadPage(++page_idx_, &page_);
+    pos_ = 0;
+  }
+}
+
+auto SortExecutor::RunCursorLess::operator()(size_t a, size_t b) const -> bool {
+  const auto &cursor_a = (*cursors_)[a];
+  const auto &cursor_b = (*cursors_)[b];
+  if (cursor_a.Exhausted() || cursor_b.Exhausted()) {
+    return !cursor_a.Exhausted();
+  }
+  return RunTupleKey(cursor_a.page_[cursor_a.pos_]) < RunTupleKey(cursor_b.page_[cursor_b.pos_]);
+}
+
+SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      buffer_arena_(exec_ctx->GetArena()) {}
+
+void SortExecutor::Init() {
+  child_executor_->Init();
+  keys_.clear();
+  tuples_.clear();
+  order_.clear();
+  buffer_arena_.Reset();
+  buffer_memory_ = 0;
+  next_idx_ = 0;
+  cursors_.clear();
+  loser_tree_.reset();
+  runs_.clear();
+  num_spilled_runs_ = 0;
+
+  Tuple tuple;
+  RID rid;
+  while (child_executor_->Next(&tuple, &rid)) {
+    auto key = NormalizedKey::Encode(tuple, child_executor_->GetOutputSchema(), plan_->GetOrderBys());
+    buffer_memory_ += key.size() + tuple.GetLength() + TUPLE_OVERHEAD;
+    keys_.emplace_back(buffer_arena_.Copy(key.data(), key.size()), key.size());
+    tuples_.push_back(Tuple::View(buffer_arena_.Copy(tuple.GetData(), tuple.GetLength()), tuple.GetLength(),
+                                  tuple.GetRid()));
+    if (buffer_memory_ > exec_ctx_->GetMemoryBudget()) {
+      SpillBuffer();
+    }
+  }
+  if (runs_.empty()) {
+    SortBuffer();
+    return;
+  }
+  if (!tuples_.empty()) {
+    SpillBuffer();
+  }
+
+  // Merge groups of runs into longer runs until the remaining runs can be merged at once.
+  auto fan_in = MaxMergeFanIn();
+  while (runs_.size() > fan_in) {
+    std::vector<std::unique_ptr<TmpTupleFile>> merged_runs;
+    for (size_t begin = 0; begin < runs_.size(); begin += fan_in) {
+      auto end = std::min(begin + fan_in, runs_.size());
+      auto merged_run = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+      StartMerge(begin, end);
+      Tuple run_tuple;
+      while (NextMerged(&run_tuple)) {
+        merged_run->Append(run_tuple);
+      }
+      merged_run->Flush();
+      merged_runs.push_back(std::move(merged_run));
+      // The merged runs are not needed any more, give their pages back right away.
+      cursors_.clear();
+      for (auto run = begin; run < end; run++) {
+        runs_[run].reset();
+      }
+    }
+    runs_ = std::move(merged_runs);
+  }
+  StartMerge(0, runs_.size());
+}
+
+auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (runs_.empty()) {
+    if (next_idx_ == order_.size()) {
+      return false;
+    }
+    *tuple = tuples_[order_[next_idx_++]];
+    // The buffer only lives as long as this executor, the parent gets its own copy
+    tuple->Materialize();
+    *rid = tuple->GetRid();
+    return true;
+  }
+  Tuple run_tuple;
+  if (!NextMerged(&run_tuple)) {
+    return false;
+  }
+  *tuple = RunTuplePayload(run_tuple);
+  *rid = RID{};
+  return true;
+}
+
+void SortExecutor::SortBuffer() {
+  order_.resize(tuples_.size());
+  std::iota(order_.begin(), order_.end(), 0);
+  std::stable_sort(order_.begin(), order_.end(), [this](uint32_t a, uint32_t b) { return keys_[a] < keys_[b]; });
+}
+
+void SortExecutor::SpillBuffer() {
+  SortBuffer();
+  auto run = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+  for (auto idx : order_) {
+    run->Append(MakeRunTuple(keys_[idx], tuples_[idx]));
+  }
+  run->Flush();
+  runs_.push_back(std::move(run));
+  num_spilled_runs_++;
+  keys_.clear();
+  tuples_.clear();
+  order_.clear();
+  buffer_arena_.Reset();
+  buffer_memory_ = 0;
+}
+
+auto SortExecutor::MaxMergeFanIn() const -> size_t {
+  return std::max<size_t>(2, exec_ctx_->GetMemoryBudget() / PAGE_SIZE);
+}
+
+void SortExecutor::StartMerge(size_t begin, size_t end) {
+  cursors_.clear();
+  for (auto run = begin; run < end; run++) {
+    RunCursor cursor{runs_[run].get(), 0, {}, 0};
+    if (cursor.run_->NumPages() > 0) {
+      cursor.run_->ReadPage(0, &cursor.page_);
+    }
+    cursors_.push_back(std::move(cursor));
+  }
+  loser_tree_ = std::make_unique<LoserTree<RunCursorLess>>(cursors_.size(), RunCursorLess{&cursors_});
+}
+
+auto SortExecutor::NextMerged(Tuple *run_tuple) -> bool {
+  auto winner = loser_tree_->Winner();
+  auto &cursor = cursors_[winner];
+  if (cursor.Exhausted()) {
+    return false;
+  }
+  *run_tuple = cursor.page_[cursor.pos_];
+  cursor.Advance();
+  loser_tree_->Next();
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// streaming_aggregation_executor.cpp
+//
+// Identification: src/execution/streaming_aggregation_executor.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "execution/executors/streaming_aggregation_executor.h"
+#include "execution/expressions/column_value_expression.h"
+
+namespace bustub {
+
+StreamingAggregationExecutor::StreamingAggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      group_(plan->GetAggregates(), plan->GetAggregateTypes()),
+      batch_(child_->GetOutputSchema()) {}
+
+void StreamingAggregationExecutor::Init() {
+  child_->Init();
+  group_.Clear();
+  batch_.Reset();
+  batch_pos_ = 0;
+  child_exhausted_ = false;
+}
+
+auto StreamingAggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (true) {
+    if (batch_pos_ == batch_.NumSelected()) {
+      batch_pos_ = 0;
+      if (child_exhausted_ || !child_->NextBatch(&batch_)) {
+        batch_.Reset();
+        child_exhausted_ = true;
+        if (group_.Size() == 0) {
+          return false;
+        }
+        if (EmitGroup(tuple)) {
+          return true;
+        }
+        continue;
+      }
+    }
+    auto row = batch_.SelectedRow(batch_pos_);
+    auto key = MakeAggregateKey(batch_, row);
+    if (group_.Size() != 0 && !(group_.Begin().Key() == key)) {
+      // The key changed, so the current group is complete. The row is aggregated on the next call.
+      if (EmitGroup(tuple)) {
+        return true;
+      }
+      continue;
+    }
+    // The table only ever holds the current group, so the key does not need a real hash.
+    group_.InsertCombine(0, key, batch_, row);
+    batch_pos_++;
+  }
+}
+
+auto StreamingAggregationExecutor::CanStream(const AggregationPlanNode *plan) -> bool {
+  if (plan->GetGroupBys().empty()) {
+    return false;
+  }
+  auto ordering = plan->GetChildPlan()->GetOutputOrdering();
+  if (ordering.size() < plan->GetGroupBys().size()) {
+    return false;
+  }
+  // Equal keys are adjacent when the group by columns are a prefix of the sort columns, in any order.
+  ordering.resize(plan->GetGroupBys().size());
+  for (const auto *group_by : plan->GetGroupBys()) {
+    auto column = dynamic_cast<const ColumnValueExpression *>(group_by);
+    if (column == nullptr || column->GetTupleIdx() != 0 ||
+        std::find(ordering.begin(), ordering.end(), column->GetColIdx()) == ordering.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto StreamingAggregationExecutor::MakeAggregateKey(const TupleBatch &batch, uint32_t row) const -> AggregateKey {
+  std::vector<Value> keys;
+  keys.reserve(plan_->GetGroupBys().size());
+  for (const auto &expr : plan_->GetGroupBys()) {
+    keys.emplace_back(expr->EvaluateBatchRow(&batch, row));
+  }
+  return {keys};
+}
+
+auto StreamingAggregationExecutor::EmitGroup(Tuple *tuple) -> bool {
+  auto iter = group_.Begin();
+  auto group_bys = iter.Key().group_bys_;
+  auto aggregates = iter.Val().aggregates_;
+  group_.Clear();
+  if (plan_->GetHaving() != nullptr && !plan_->GetHaving()->EvaluateAggregate(group_bys, aggregates).GetAs<bool>()) {
+    return false;
+  }
+  std::vector<Value> values;
+  values.reserve(plan_->OutputSchema()->GetColumnCount());
+  for (const Column &column : plan_->OutputSchema()->GetColumns()) {
+    values.emplace_back(column.GetExpr()->EvaluateAggregate(group_bys, aggregates));
+  }
+  *tuple = Tuple(values, plan_->OutputSchema());
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.cpp
+//
+// Identification: src/execution/topn_executor.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "execution/executors/topn_executor.h"
+#include "execution/normalized_key.h"
+
+namespace bustub {
+
+TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx),
+      output_schema_(plan->OutputSchema()),
+      order_bys_(plan->GetOrderBys()),
+      n_(plan->GetN()),
+      child_executor_(std::move(child_executor)) {}
+
+TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *limit_plan, const SortPlanNode *sort_plan,
+                           std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx),
+      output_schema_(limit_plan->OutputSchema()),
+      order_bys_(sort_plan->GetOrderBys()),
+      n_(limit_plan->GetLimit()),
+      child_executor_(std::move(child_executor)) {}
+
+void TopNExecutor::Init() {
+  child_executor_->Init();
+  keys_.clear();
+  tuples_.clear();
+  heap_.clear();
+  next_idx_ = 0;
+  if (n_ == 0) {
+    return;
+  }
+
+  auto key_less = [this](uint32_t a, uint32_t b) { return KeyLess(a, b); };
+  Tuple tuple;
+  RID rid;
+  std::string key;
+  while (child_executor_->Next(&tuple, &rid)) {
+    if (!EncodeIfAdmitted(tuple, &key)) {
+      continue;
+    }
+    if (heap_.size() < n_) {
+      keys_.push_back(key);
+      tuples_.push_back(tuple);
+      heap_.push_back(static_cast<uint32_t>(heap_.size()));
+      std::push_heap(heap_.begin(), heap_.end(), key_less);
+      continue;
+    }
+    // The tuple replaces the worst retained one and reuses its slot.
+    std::pop_heap(heap_.begin(), heap_.end(), key_less);
+    auto slot = heap_.back();
+    keys_[slot] = key;
+    tuples_[slot] = tuple;
+    std::push_heap(heap_.begin(), heap_.end(), key_less);
+  }
+  std::sort_heap(heap_.begin(), heap_.end(), key_less);
+}
+
+auto TopNExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (next_idx_ == heap_.size()) {
+    return false;
+  }
+  *tuple = tuples_[heap_[next_idx_++]];
+  *rid = tuple->GetRid();
+  return true;
+}
+
+auto TopNExecutor::EncodeIfAdmitted(const Tuple &tuple, std::string *key) const -> bool {
+  const auto *schema = child_executor_->GetOutputSchema();
+  if (heap_.size() < n_) {
+    *key = NormalizedKey::Encode(tuple, schema, order_bys_);
+    return true;
+  }
+  // Keys are prefix-free column by column, so the encoded prefix compared with the same-length prefix of the top's
+  // key decides as soon as the two differ.
+  const auto &top_key = keys_[heap_.front()];
+  key->clear();
+  size_t col = 0;
+  int cmp = 0;
+  while (cmp == 0 && col < order_bys_.size()) {
+    const auto &[order_by_type, expr] = order_bys_[col++];
+    NormalizedKey::Append(expr->Evaluate(&tuple, schema), order_by_type, key);
+    cmp = key->compare(0, key->size(), top_key, 0, key->size());
+  }
+  if (cmp >= 0) {
+    // Ties with the top are rejected too, earlier tuples win.
+    return false;
+  }
+  for (; col < order_bys_.size(); col++) {
+    NormalizedKey::Append(order_bys_[col].second->Evaluate(&tuple, schema), order_bys_[col].first, key);
+  }
+  return true;
+}
+
+}  // namespace bustub
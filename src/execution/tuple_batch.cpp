@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include "type/value_factory.h"
+
+namespace bustub {
+
+void ColumnVector::Append(const Value &value) {
+  bool is_null = value.IsNull();
+  nulls_.push_back(static_cast<uint8_t>(is_null));
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      integers_.push_back(is_null ? 0 : value.GetAs<int8_t>());
+      break;
+    case TypeId::SMALLINT:
+      integers_.push_back(is_null ? 0 : value.GetAs<int16_t>());
+      break;
+    case TypeId::INTEGER:
+      integers_.push_back(is_null ? 0 : value.GetAs<int32_t>());
+      break;
+    case TypeId::BIGINT:
+    case TypeId::TIMESTAMP:
+      integers_.push_back(is_null ? 0 : value.GetAs<int64_t>());
+      break;
+    case TypeId::DECIMAL:
+      decimals_.push_back(is_null ? 0 : value.GetAs<double>());
+      break;
+    default:
+      varlens_.push_back(value);
+      break;
+  }
+}
+
+auto ColumnVector::GetValue(uint32_t row) const -> Value {
+  if (nulls_[row] != 0) {
+    return ValueFactory::GetNullValueByType(type_);
+  }
+  switch (type_) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(static_cast<int8_t>(integers_[row]));
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(integers_[row]));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(integers_[row]));
+    case TypeId::INTEGER:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(integers_[row]));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(integers_[row]);
+    case TypeId::TIMESTAMP:
+      return ValueFactory::GetTimestampValue(integers_[row]);
+    case TypeId::DECIMAL:
+      return ValueFactory::GetDecimalValue(decimals_[row]);
+    default:
+      return varlens_[row];
+  }
+}
+
+void ColumnVector::Clear() {
+  integers_.clear();
+  decimals_.clear();
+  varlens_.clear();
+  nulls_.clear();
+}
+
+TupleBatch::TupleBatch(const Schema *schema, uint32_t capacity) : schema_(schema), capacity_(capacity) {
+  columns_.reserve(schema_->GetColumnCount());
+  for (const auto &column : schema_->GetColumns()) {
+    columns_.emplace_back(column.GetType());
+  }
+  rids_.reserve(capacity_);
+}
+
+void TupleBatch::Reset() {
+  for (auto &column : columns_) {
+    column.Clear();
+  }
+  rids_.clear();
+  tuples_.clear();
+  selection_.clear();
+  has_selection_ = false;
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, RID rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].Append(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+}
+
+auto TupleBatch::GetTuple(uint32_t row) const -> Tuple {
+  if (!tuples_.empty()) {
+    return tuples_[row];
+  }
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.emplace_back(column.GetValue(row));
+  }
+  Tuple tuple(values, schema_);
+  tuple.SetRid(rids_[row]);
+  return tuple;
+}
+
+}  // namespace bustub
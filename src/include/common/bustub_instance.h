@@ -10,10 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/config.h"
+#include "common/task_scheduler.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
@@ -40,12 +43,16 @@ class BustubInstance {
 
     // checkpoints
     checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
+
+    // query execution: the thread running a query works on it too, so one worker fewer than there are cores
+    task_scheduler_ = new TaskScheduler(std::max(std::thread::hardware_concurrency(), 2U) - 1);
   }
 
   ~BustubInstance() {
     if (enable_logging) {
       log_manager_->StopFlushThread();
     }
+    delete task_scheduler_;
     delete checkpoint_manager_;
     delete log_manager_;
     delete buffer_pool_manager_;
@@ -60,6 +67,8 @@ class BustubInstance {
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  /** Runs the parallel work of all queries; give each query a TaskGroup through ExecutorContext::SetTaskGroup() */
+  TaskScheduler *task_scheduler_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler.h
+//
+// Identification: src/include/common/task_scheduler.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+class TaskScheduler;
+
+/**
+ * The tasks of one query. Operators that run in parallel hand their work to the scheduler through RunParallel(),
+ * and the group decides how the query competes with other queries for the scheduler's workers.
+ */
+class TaskGroup {
+ public:
+  DISALLOW_COPY_AND_MOVE(TaskGroup);
+
+  /**
+   * Runs task(task_idx) for every task_idx in [0, num_tasks) and waits for all of them. Task 0 runs on the calling
+   * thread, the others are queued for the scheduler's workers; while it waits, the calling thread runs queued tasks
+   * of this group itself, so the call finishes even if no worker is free and may be nested inside another task.
+   *
+   * If the group is cancelled, tasks that have not started yet are skipped. If a task throws, the first exception is
+   * rethrown once all tasks are done.
+   * @param num_tasks the number of tasks, at least 1
+   * @param task the task
+   */
+  void RunParallel(uint32_t num_tasks, const std::function<void(uint32_t)> &task);
+
+  /** Skips all tasks of the group that have not started yet; running tasks can poll IsCancelled(). */
+  void Cancel() { cancelled_ = true; }
+
+  /** @return whether the group was cancelled */
+  auto IsCancelled() const -> bool { return cancelled_; }
+
+  /** @return the priority of the group, workers take tasks of groups with higher priorities first */
+  auto GetPriority() const -> int { return priority_; }
+
+  /** @return the maximum number of workers running tasks of the group at once, not counting the calling thread */
+  auto GetMaxConcurrency() const -> uint32_t { return max_concurrency_; }
+
+ private:
+  friend class TaskScheduler;
+
+  /** The tasks queued by one RunParallel() call */
+  struct Batch {
+    const std::function<void(uint32_t)> *task_;
+    /** Tasks not finished yet, guarded by the scheduler latch */
+    uint32_t remaining_;
+    /** The first exception thrown by a task */
+    std::exception_ptr exception_;
+  };
+
+  /** A queued task */
+  struct Task {
+    Batch *batch_;
+    uint32_t task_idx_;
+  };
+
+  TaskGroup(TaskScheduler *scheduler, int priority, uint32_t max_concurrency)
+      : scheduler_(scheduler), priority_(priority), max_concurrency_(max_concurrency) {}
+
+  TaskScheduler *scheduler_;
+  int priority_;
+  uint32_t max_concurrency_;
+  std::atomic<bool> cancelled_{false};
+
+  /** Queued tasks, guarded by the scheduler latch */
+  std::deque<Task> tasks_;
+  /** Number of workers running tasks of the group, guarded by the scheduler latch */
+  uint32_t running_{0};
+  /** When a worker last took a task of the group, used to rotate between groups of equal priority */
+  uint64_t last_served_{0};
+};
+
+/**
+ * TaskScheduler runs the parallel tasks of all queries on a fixed pool of worker threads, so the number of threads
+ * does not grow with the number of concurrent queries.
+ *
+ * Each query gets a TaskGroup with a priority and a concurrency cap. An idle worker steals the oldest queued task
+ * of the highest priority group that is below its cap, rotating between groups of equal priority so that concurrent
+ * queries share the workers fairly. The thread that started a query always works on its own group as well, so a
+ * query progresses even when every worker is busy elsewhere.
+ */
+class TaskScheduler {
+ public:
+  /** Maximum concurrency of a group that is not capped */
+  static constexpr uint32_t UNLIMITED_CONCURRENCY = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * Creates a new TaskScheduler and starts its workers.
+   * @param num_workers the number of worker threads
+   */
+  explicit TaskScheduler(uint32_t num_workers);
+
+  /** Stops the workers. All groups must be done with RunParallel() by then. */
+  ~TaskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(TaskScheduler);
+
+  /**
+   * Creates the task group of a query.
+   * @param priority the priority of the query, higher priorities are scheduled first
+   * @param max_concurrency the maximum number of workers that may run tasks of the query at once
+   * @return the new group
+   */
+  auto CreateTaskGroup(int priority = 0, uint32_t max_concurrency = UNLIMITED_CONCURRENCY)
+      -> std::unique_ptr<TaskGroup>;
+
+  /** @return the number of worker threads */
+  auto GetNumWorkers() const -> uint32_t { return static_cast<uint32_t>(workers_.size()); }
+
+ private:
+  friend class TaskGroup;
+
+  /** Queues the tasks of a batch, task 0 excluded. */
+  void Submit(TaskGroup *group, TaskGroup::Batch *batch, uint32_t num_tasks);
+
+  /**
+   * Runs queued tasks of group on the calling thread until batch is done.
+   * @param lock the held scheduler latch
+   */
+  void Help(TaskGroup *group, TaskGroup::Batch *batch, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Runs one task with the latch released and marks it as finished.
+   * @param lock the held scheduler latch
+   */
+  void RunTask(TaskGroup *group, const TaskGroup::Task &task, std::unique_lock<std::mutex> *lock);
+
+  /** @return the group a worker should take its next task from, nullptr if there is none. Requires the latch. */
+  auto PickGroup() -> TaskGroup *;
+
+  void WorkerLoop();
+
+  std::mutex latch_;
+  /** Signalled whenever a task is queued or finishes */
+  std::condition_variable cv_;
+  /** Groups with queued tasks, guarded by latch_ */
+  std::vector<TaskGroup *> active_groups_;
+  /** Counts the tasks handed to workers, guarded by latch_ */
+  uint64_t clock_{0};
+  bool shutdown_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
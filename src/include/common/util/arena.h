@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena.h
+//
+// Identification: src/include/common/util/arena.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Bump allocator handing out memory from a list of growing blocks. Individual allocations are never freed; all of
+ * them are released at once by Reset() or when the arena is destroyed.
+ *
+ * Arenas form a tree for accounting: the blocks of an arena are charged to it and to all of its ancestors, so the
+ * per-query arena of an ExecutorContext sees the memory of every operator arena created under it. Charging more
+ * than the limit of any arena on the way up throws an OUT_OF_MEMORY Exception.
+ *
+ * Memory an operator holds outside of arenas, such as the entries of a hash table, is accounted with Reserve() so it
+ * counts towards the same peaks and limits.
+ *
+ * Allocate(), Reserve(), Release() and Reset() must not be called concurrently on the same arena, but arenas used by
+ * different threads may share a parent.
+ */
+class Arena {
+ public:
+  /**
+   * Creates a top-level arena.
+   * @param limit the most bytes the arena and its children may hold at once
+   */
+  explicit Arena(size_t limit = std::numeric_limits<size_t>::max()) : limit_(limit) {}
+
+  /**
+   * Creates an arena whose memory is also charged to parent.
+   * @param parent the arena to charge, must outlive this one
+   */
+  explicit Arena(Arena *parent) : parent_(parent) {}
+
+  ~Arena() { Reset(); }
+
+  DISALLOW_COPY_AND_MOVE(Arena);
+
+  /**
+   * Allocates memory that stays valid until the next Reset().
+   * @param size the number of bytes
+   * @param alignment the alignment of the memory, a power of two
+   * @return the memory
+   * @throws Exception if a memory limit would be exceeded
+   */
+  auto Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) -> char *;
+
+  /**
+   * Copies bytes into the arena.
+   * @param data the bytes to copy
+   * @param size the number of bytes
+   * @return the copy
+   */
+  auto Copy(const char *data, size_t size) -> char *;
+
+  /**
+   * Charges memory held outside the arena to it, until it is released by Release() or Reset().
+   * @param bytes the number of bytes
+   * @throws Exception if a memory limit would be exceeded
+   */
+  void Reserve(size_t bytes);
+
+  /** @param bytes the number of bytes of earlier Reserve() calls that are no longer held */
+  void Release(size_t bytes);
+
+  /** Releases all memory of this arena, allocated or reserved; memory of child arenas is not affected. */
+  void Reset();
+
+  /** @return the bytes currently held by this arena and its children */
+  auto GetUsedBytes() const -> size_t { return used_.load(); }
+
+  /** @return the most bytes held at once by this arena and its children since creation or ResetPeak() */
+  auto GetPeakBytes() const -> size_t { return peak_.load(); }
+
+  /** Restart peak tracking from the current usage. */
+  void ResetPeak() { peak_ = used_.load(); }
+
+  /** @return the most bytes this arena and its children may hold at once */
+  auto GetLimit() const -> size_t { return limit_; }
+
+  /** @param limit the most bytes this arena and its children may hold at once */
+  void SetLimit(size_t limit) { limit_ = limit; }
+
+ private:
+  /** Size of the first block; later blocks double up to MAX_BLOCK_SIZE */
+  static constexpr size_t MIN_BLOCK_SIZE = 4096;
+  static constexpr size_t MAX_BLOCK_SIZE = 1 << 20;
+
+  /** Add bytes to the usage of this arena and its ancestors, undoing everything if a limit is exceeded. */
+  void Charge(size_t bytes);
+
+  /** Remove bytes from the usage of this arena and its ancestors. */
+  void Uncharge(size_t bytes);
+
+  Arena *parent_{nullptr};
+  size_t limit_{std::numeric_limits<size_t>::max()};
+  std::atomic<size_t> used_{0};
+  std::atomic<size_t> peak_{0};
+
+  /** The blocks of this arena; allocations are carved from the end of the last one */
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  /** Bytes of blocks_ charged by this arena itself */
+  size_t block_bytes_{0};
+  /** Bytes charged by Reserve() and not released yet */
+  size_t reserved_bytes_{0};
+  char *cursor_{nullptr};
+  size_t remaining_{0};
+  size_t next_block_size_{MIN_BLOCK_SIZE};
+};
+
+}  // namespace bustub
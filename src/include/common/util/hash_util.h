@@ -45,6 +45,21 @@ class HashUtil {
     return HashBytes(reinterpret_cast<char *>(both), sizeof(hash_t) * 2);
   }
 
+  /**
+   * HashBytes keeps most of its entropy in the low bits. MixHash spreads it over all 64 bits (murmur3 finalizer), so
+   * that any subset of bits, e.g. the high bits used to pick a partition, is usable.
+   * @return the mixed hash
+   */
+  static inline auto MixHash(hash_t hash) -> uint64_t {
+    uint64_t mixed = hash;
+    mixed ^= mixed >> 33;
+    mixed *= 0xff51afd7ed558ccdULL;
+    mixed ^= mixed >> 33;
+    mixed *= 0xc4ceb9fe1a85ec53ULL;
+    mixed ^= mixed >> 33;
+    return mixed;
+  }
+
   static inline auto SumHashes(hash_t l, hash_t r) -> hash_t {
     return (l % PRIME_FACTOR + r % PRIME_FACTOR) % PRIME_FACTOR;
   }
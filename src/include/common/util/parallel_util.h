@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_util.h
+//
+// Identification: src/include/common/util/parallel_util.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/**
+ * Runs task(thread_idx) on num_threads threads, including the calling one, and waits for all of them. If tasks
+ * throw, the first exception is rethrown once all threads are done.
+ * @param num_threads the number of threads, at least 1
+ * @param task the task, thread_idx ranges over [0, num_threads)
+ */
+inline void RunParallel(uint32_t num_threads, const std::function<void(uint32_t)> &task) {
+  std::mutex latch;
+  std::exception_ptr exception;
+  auto run = [&](uint32_t thread_idx) {
+    try {
+      task(thread_idx);
+    } catch (...) {
+      std::scoped_lock lock{latch};
+      if (exception == nullptr) {
+        exception = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads - 1);
+  for (uint32_t i = 1; i < num_threads; i++) {
+    workers.emplace_back(run, i);
+  }
+  run(0);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (exception != nullptr) {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace bustub
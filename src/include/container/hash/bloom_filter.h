@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/container/hash/bloom_filter.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+/**
+ * Register-blocked Bloom filter over precomputed hashes.
+ *
+ * Every key sets NUM_PROBES bits inside a single 64-bit word, so a lookup touches one word and needs no loop over
+ * separate hash functions. The word and the bit positions are taken from disjoint bits of the mixed hash.
+ */
+class BloomFilter {
+ public:
+  /**
+   * Creates an empty BloomFilter.
+   * @param expected_keys the number of keys the filter is sized for
+   */
+  explicit BloomFilter(size_t expected_keys) {
+    size_t num_words = 1;
+    while (num_words * 64 < expected_keys * BITS_PER_KEY) {
+      num_words *= 2;
+    }
+    words_.assign(num_words, 0);
+  }
+
+  /** @param hash the hash of the key to add */
+  void Insert(hash_t hash) {
+    auto mixed = HashUtil::MixHash(hash);
+    words_[mixed & (words_.size() - 1)] |= BitsOf(mixed);
+  }
+
+  /** @return false if the key with this hash was definitely not inserted */
+  auto MayContain(hash_t hash) const -> bool {
+    auto mixed = HashUtil::MixHash(hash);
+    auto bits = BitsOf(mixed);
+    return (words_[mixed & (words_.size() - 1)] & bits) == bits;
+  }
+
+ private:
+  /** Blocking costs some accuracy, 16 bits per key keep false positives at around 1% */
+  static constexpr size_t BITS_PER_KEY = 16;
+  static constexpr uint32_t NUM_PROBES = 4;
+
+  /** @return the bits of a key within its word, taken from 6-bit fields at the top of the hash */
+  static auto BitsOf(uint64_t mixed) -> uint64_t {
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < NUM_PROBES; i++) {
+      bits |= uint64_t{1} << ((mixed >> (58 - 6 * i)) & 63);
+    }
+    return bits;
+  }
+
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace bustub
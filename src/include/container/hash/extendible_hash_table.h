@@ -24,14 +24,23 @@
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+#define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator, HashFn>
 
 /**
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * The hash function is a template parameter so that a specialized hash (e.g.
+ * FastIntegerHashFunction for single integer keys) can be chosen at compile
+ * time without virtual dispatch or slicing.
+ *
+ * The directory is a single page of DIRECTORY_ARRAY_SIZE (512) slots, so the
+ * global depth is capped at 9 and only the low 9 bits of a hash select a
+ * bucket. An insert into a full bucket that would need a deeper directory
+ * fails.
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn = HashFunction<KeyType>>
 class ExtendibleHashTable {
  public:
   /**
@@ -42,7 +51,7 @@ class ExtendibleHashTable {
    * @param hash_fn the hash function
    */
   explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+                               const KeyComparator &comparator, HashFn hash_fn);
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -85,13 +94,13 @@ class ExtendibleHashTable {
   void VerifyIntegrity();
 
   /**
-   * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
-   * for extendible hashing.
+   * Hash - returns the full 64-bit hash of the key. Directory indexes take
+   * the low global-depth bits of it.
    *
    * @param key the key to hash
-   * @return the downcasted 32-bit hash
+   * @return the 64-bit hash
    */
-  inline uint32_t Hash(KeyType key);
+  inline uint64_t Hash(KeyType key);
 
   /**
    * KeyToDirectoryIndex - maps a key to a directory index
@@ -102,8 +111,8 @@ class ExtendibleHashTable {
    * DirectoryIndex = Hash(key) & GLOBAL_DEPTH_MASK
    *
    * where GLOBAL_DEPTH_MASK is a mask with exactly GLOBAL_DEPTH 1's from LSB
-   * upwards.  For example, global depth 3 corresponds to 0x00000007 in a 32-bit
-   * representation.
+   * upwards.  For example, global depth 3 corresponds to 0x0000000000000007 in a
+   * 64-bit representation.
    *
    * @param key the key to use for lookup
    * @param dir_page to use for lookup of global depth
@@ -160,11 +169,6 @@ class ExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
-  /**
-   * Pow function for uint32_t
-   */
-  uint32_t Pow(uint32_t base, uint32_t power) const;
-
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
@@ -172,7 +176,7 @@ class ExtendibleHashTable {
 
   // Readers includes inserts and removes, writers are splits and merges
   ReaderWriterLatch table_latch_;
-  HashFunction<KeyType> hash_fn_;
+  HashFn hash_fn_;
 };
 
 }  // namespace bustub
@@ -12,7 +12,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
 
 #include "murmur3/MurmurHash3.h"
 
@@ -21,6 +27,8 @@ namespace bustub {
 template <typename KeyType>
 class HashFunction {
  public:
+  virtual ~HashFunction() = default;
+
   /**
    * @param key the key to be hashed
    * @return the hashed value
@@ -33,4 +41,64 @@ class HashFunction {
   }
 };
 
+/**
+ * Base for hash functions over keys that hold a single fixed-width integer in their leading bytes, e.g. a
+ * GenericKey built from one INTEGER or BIGINT column. Only those (at most 8) bytes are hashed, so the zero
+ * padding of a wide GenericKey is never touched.
+ */
+template <typename KeyType>
+class IntegerKeyHashFunction : public HashFunction<KeyType> {
+ protected:
+  /** @return the leading integer bytes of the key, zero-extended to 64 bits */
+  static auto LoadInteger(const KeyType &key) -> uint64_t {
+    uint64_t raw = 0;
+    memcpy(&raw, &key, std::min(sizeof(KeyType), sizeof(uint64_t)));
+    return raw;
+  }
+};
+
+/**
+ * Multiply-shift hash: a 64x64->128 bit multiply by an odd constant, folded so that the low bits used for the
+ * directory index depend on every input bit.
+ */
+template <typename KeyType>
+class MultiplyShiftHashFunction : public IntegerKeyHashFunction<KeyType> {
+ public:
+  auto GetHash(KeyType key) -> uint64_t override {
+    auto product = static_cast<__uint128_t>(this->LoadInteger(key)) * MULTIPLIER;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  }
+
+ private:
+  /** 2^64 / golden ratio, rounded to odd */
+  static constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+};
+
+#ifdef __SSE4_2__
+/**
+ * CRC32C hash computed with the SSE4.2 crc32 instruction. Two CRCs with different seeds are concatenated to
+ * produce a full 64-bit hash.
+ */
+template <typename KeyType>
+class Crc32cHashFunction : public IntegerKeyHashFunction<KeyType> {
+ public:
+  auto GetHash(KeyType key) -> uint64_t override {
+    auto raw = this->LoadInteger(key);
+    return (_mm_crc32_u64(SEED_HIGH, raw) << 32) | _mm_crc32_u64(SEED_LOW, raw);
+  }
+
+ private:
+  static constexpr uint64_t SEED_HIGH = 0x5bd1e995;
+  static constexpr uint64_t SEED_LOW = 0x1b873593;
+};
+
+/** The fastest integer key hash available on the target, chosen at compile time. */
+template <typename KeyType>
+using FastIntegerHashFunction = Crc32cHashFunction<KeyType>;
+#else
+/** The fastest integer key hash available on the target, chosen at compile time. */
+template <typename KeyType>
+using FastIntegerHashFunction = MultiplyShiftHashFunction<KeyType>;
+#endif
+
 }  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// open_addressing_hash_table.h
+//
+// Identification: src/include/container/hash/open_addressing_hash_table.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+/**
+ * In-memory (non-paged) hash table used by executors for joins, group-bys and DISTINCT.
+ *
+ * Entries are appended to an arena of fixed-size chunks, so inserting never allocates a node per entry and
+ * references to values stay valid while the table grows. The slot array is a power-of-two sized linear probing
+ * table of (entry index, hash tag) pairs; the tag lets most mismatches be rejected without touching the entry.
+ *
+ * Callers pass in a precomputed hash for every lookup, so a row is hashed exactly once no matter how many times
+ * the table is probed with it. Each entry keeps its full hash, which means growing the table never rehashes keys.
+ *
+ * Iteration visits entries in insertion order. Keys are unique; a multimap is built by making the value a list.
+ */
+template <typename KeyType, typename ValueType, typename KeyEqual = std::equal_to<KeyType>>
+class OpenAddressingHashTable {
+ public:
+  /** A key/value pair stored in the arena together with the hash of its key */
+  struct Entry {
+    hash_t hash_;
+    KeyType key_;
+    ValueType value_;
+  };
+
+  /**
+   * Creates a new OpenAddressingHashTable.
+   * @param expected_size the number of entries the table should hold before it has to grow
+   */
+  explicit OpenAddressingHashTable(size_t expected_size = 0) { Reset(expected_size); }
+
+  /**
+   * Looks up a key.
+   * @param hash the hash of the key
+   * @param key the key to look up
+   * @return a pointer to the value of the key, or nullptr if the key is not in the table
+   */
+  auto Find(hash_t hash, const KeyType &key) -> ValueType * {
+    auto pos = Probe(hash, key);
+    return slots_[pos].IsEmpty() ? nullptr : &EntryAt(slots_[pos].entry_idx_).value_;
+  }
+
+  /**
+   * Looks up a key.
+   * @param hash the hash of the key
+   * @param key the key to look up
+   * @return a pointer to the value of the key, or nullptr if the key is not in the table
+   */
+  auto Find(hash_t hash, const KeyType &key) const -> const ValueType * {
+    auto pos = Probe(hash, key);
+    return slots_[pos].IsEmpty() ? nullptr : &EntryAt(slots_[pos].entry_idx_).value_;
+  }
+
+  /**
+   * Looks up a key, inserting it with the value returned by make_value() if it is not in the table yet.
+   * @param hash the hash of the key
+   * @param key the key to look up
+   * @param make_value callable producing the initial value of a new key
+   * @return a pointer to the value of the key and whether the key was inserted
+   */
+  template <typename MakeValue>
+  auto FindOrInsert(hash_t hash, const KeyType &key, MakeValue &&make_value) -> std::pair<ValueType *, bool> {
+    auto pos = Probe(hash, key);
+    if (!slots_[pos].IsEmpty()) {
+      return {&EntryAt(slots_[pos].entry_idx_).value_, false};
+    }
+    if ((size_ + 1) * MAX_LOAD_DENOMINATOR > slots_.size() * MAX_LOAD_NUMERATOR) {
+      Grow();
+      pos = Probe(hash, key);
+    }
+    if (chunks_.empty() || chunks_.back().size() == CHUNK_SIZE) {
+      chunks_.emplace_back();
+      chunks_.back().reserve(CHUNK_SIZE);
+    }
+    chunks_.back().push_back(Entry{hash, key, make_value()});
+    slots_[pos] = Slot{static_cast<uint32_t>(size_), Tag(hash)};
+    size_++;
+    return {&chunks_.back().back().value_, true};
+  }
+
+  /** @return the number of entries in the table */
+  auto Size() const -> size_t { return size_; }
+
+  /** @return the entry_idx'th entry in insertion order */
+  auto EntryAt(size_t entry_idx) -> Entry & { return chunks_[entry_idx / CHUNK_SIZE][entry_idx % CHUNK_SIZE]; }
+
+  /** @return the entry_idx'th entry in insertion order */
+  auto EntryAt(size_t entry_idx) const -> const Entry & {
+    return chunks_[entry_idx / CHUNK_SIZE][entry_idx % CHUNK_SIZE];
+  }
+
+  /** Removes all entries and releases the arena. */
+  void Clear() { Reset(0); }
+
+ private:
+  /** Slot of the probing array; entry_idx_ == EMPTY_SLOT marks a free slot */
+  struct Slot {
+    uint32_t entry_idx_;
+    uint32_t tag_;
+    auto IsEmpty() const -> bool { return entry_idx_ == EMPTY_SLOT; }
+  };
+
+  static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+  /** Number of entries per arena chunk */
+  static constexpr size_t CHUNK_SIZE = 1024;
+  /** The slot array grows once it is more than 7/10 full */
+  static constexpr size_t MAX_LOAD_NUMERATOR = 7;
+  static constexpr size_t MAX_LOAD_DENOMINATOR = 10;
+  static constexpr size_t MIN_CAPACITY = 16;
+
+  /** @return the bits of the hash that are not used to pick the home slot */
+  static auto Tag(hash_t hash) -> uint32_t { return static_cast<uint32_t>(static_cast<uint64_t>(hash) >> 32); }
+
+  /** @return the slot holding the key, or the empty slot where it would be inserted */
+  auto Probe(hash_t hash, const KeyType &key) const -> size_t {
+    auto tag = Tag(hash);
+    for (size_t pos = hash & mask_;; pos = (pos + 1) & mask_) {
+      const auto &slot = slots_[pos];
+      if (slot.IsEmpty()) {
+        return pos;
+      }
+      if (slot.tag_ == tag) {
+        const auto &entry = EntryAt(slot.entry_idx_);
+        if (entry.hash_ == hash && key_equal_(entry.key_, key)) {
+          return pos;
+        }
+      }
+    }
+  }
+
+  /** Doubles the slot array and re-inserts every entry using its stored hash. */
+  void Grow() {
+    slots_.assign(slots_.size() * 2, Slot{EMPTY_SLOT, 0});
+    mask_ = slots_.size() - 1;
+    for (size_t entry_idx = 0; entry_idx < size_; entry_idx++) {
+      auto hash = EntryAt(entry_idx).hash_;
+      auto pos = hash & mask_;
+      while (!slots_[pos].IsEmpty()) {
+        pos = (pos + 1) & mask_;
+      }
+      slots_[pos] = Slot{static_cast<uint32_t>(entry_idx), Tag(hash)};
+    }
+  }
+
+  void Reset(size_t expected_size) {
+    size_t capacity = MIN_CAPACITY;
+    while (expected_size * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+      capacity *= 2;
+    }
+    slots_.assign(capacity, Slot{EMPTY_SLOT, 0});
+    mask_ = capacity - 1;
+    chunks_.clear();
+    size_ = 0;
+  }
+
+  /** The probing array, its size is always a power of two */
+  std::vector<Slot> slots_;
+  /** slots_.size() - 1 */
+  size_t mask_{0};
+  /** Arena of entries in insertion order; chunks are never reallocated once created */
+  std::vector<std::vector<Entry>> chunks_;
+  /** The number of entries */
+  size_t size_{0};
+  KeyEqual key_equal_{};
+};
+
+}  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <functional>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -20,6 +22,7 @@
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 namespace bustub {
 
@@ -39,6 +42,13 @@ class ExecutionEngine {
 
   DISALLOW_COPY_AND_MOVE(ExecutionEngine);
 
+  /**
+   * Called with every batch of result rows as soon as it is produced. Only the selected rows of the batch are part
+   * of the result, and the batch is only valid during the call.
+   * @return `true` to continue the query, `false` to stop it without producing the remaining rows
+   */
+  using ResultCallback = std::function<bool(const TupleBatch &)>;
+
   /**
    * Execute a query plan.
    * @param plan The query plan to execute
@@ -49,29 +59,82 @@ class ExecutionEngine {
    */
   auto Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
                ExecutorContext *exec_ctx) -> bool {
+    return Execute(
+        plan,
+        [result_set](const TupleBatch &batch) {
+          for (uint32_t i = 0; result_set != nullptr && i < batch.NumSelected(); i++) {
+            result_set->push_back(batch.GetTuple(batch.SelectedRow(i)));
+          }
+          return true;
+        },
+        txn, exec_ctx);
+  }
+
+  /**
+   * Execute a query plan, streaming its result to a callback. The next batch is only produced after the callback
+   * returned, so a slow consumer slows down the query instead of the result piling up in memory.
+   * @param plan The query plan to execute
+   * @param on_batch The callback receiving the result rows, never called for plans without an output schema
+   * @param txn The transaction context in which the query executes
+   * @param exec_ctx The executor context in which the query executes
+   * @return `true` if execution of the query plan succeeds, `false` otherwise
+   */
+  auto Execute(const AbstractPlanNode *plan, const ResultCallback &on_batch, Transaction *txn,
+               ExecutorContext *exec_ctx) -> bool {
+    exec_ctx->GetArena()->ResetPeak();
+
     // Construct and executor for the plan
     auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
 
-    // Prepare the root executor
-    executor->Init();
-
-    // Execute the query plan
+    // Prepare the root executor and execute the query plan, batch at a time unless the plan produces no output rows
+    // (e.g. insert). Init() builds the tables of blocking operators, so it may fail like Next() does.
+    bool success = true;
     try {
-      Tuple tuple;
-      RID rid;
-      while (executor->Next(&tuple, &rid)) {
-        if (result_set != nullptr) {
-          result_set->push_back(tuple);
+      executor->Init();
+      if (executor->GetOutputSchema() == nullptr) {
+        Tuple tuple;
+        RID rid;
+        while (!exec_ctx->IsCancelled() && executor->Next(&tuple, &rid)) {
+        }
+      } else {
+        TupleBatch batch(executor->GetOutputSchema());
+        while (!exec_ctx->IsCancelled() && NextResultBatch(executor.get(), &batch)) {
+          if (batch.NumSelected() > 0 && !on_batch(batch)) {
+            break;
+          }
         }
       }
     } catch (Exception &e) {
-      // TODO(student): handle exceptions
+      // The rows handed out so far are only part of the result, e.g. when the query memory limit was exceeded
+      success = false;
     }
 
-    return true;
+    // The result rows were handed out as they were produced, so everything the query allocated can go at once
+    executor.reset();
+    exec_ctx->GetArena()->Reset();
+    // A cancelled query stops between batches and its partial result is not a result
+    return success && !exec_ctx->IsCancelled();
   }
 
  private:
+  /**
+   * Fills a batch with the next result rows of the root executor. The rows of an executor that is not vectorized
+   * are pulled through Next() and handed on as they are, so they are not split into columns and keep their RIDs.
+   * @return `true` if the batch has rows, `false` if there are no more
+   */
+  static auto NextResultBatch(AbstractExecutor *executor, TupleBatch *batch) -> bool {
+    if (executor->IsVectorized()) {
+      return executor->NextBatch(batch);
+    }
+    batch->Reset();
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && executor->Next(&tuple, &rid)) {
+      batch->AppendRow(std::move(tuple), rid);
+    }
+    return batch->NumRows() > 0;
+  }
+
   /** The buffer pool manager used during query execution */
   [[maybe_unused]] BufferPoolManager *bpm_;
   /** The transaction manager used during query execution */
@@ -17,10 +17,20 @@
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/task_scheduler.h"
+#include "common/util/arena.h"
+#include "common/util/parallel_util.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
+
+/** Default number of bytes an operator may keep in memory before it spills to temporary pages */
+static constexpr size_t DEFAULT_EXECUTOR_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+/** Default number of bytes all arenas of a query may hold at once */
+static constexpr size_t DEFAULT_QUERY_MEMORY_LIMIT = 1024 * 1024 * 1024;
+
 /**
  * ExecutorContext stores all the context necessary to run an executor.
  */
@@ -60,6 +70,50 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /** @return the number of bytes a memory intensive operator may use before it spills to disk */
+  auto GetMemoryBudget() const -> size_t { return memory_budget_; }
+
+  /** @param memory_budget the number of bytes a memory intensive operator may use before it spills to disk */
+  void SetMemoryBudget(size_t memory_budget) { memory_budget_ = memory_budget; }
+
+  /** @return the number of threads an operator that supports intra-query parallelism may use */
+  auto GetParallelism() const -> uint32_t { return parallelism_; }
+
+  /** @param parallelism the number of threads an operator that supports intra-query parallelism may use */
+  void SetParallelism(uint32_t parallelism) { parallelism_ = parallelism; }
+
+  /** @return the task group the query's parallel work is scheduled in, nullptr if it spawns its own threads */
+  auto GetTaskGroup() const -> TaskGroup * { return task_group_; }
+
+  /** @param task_group the task group to schedule the query's parallel work in, owned by the caller */
+  void SetTaskGroup(TaskGroup *task_group) { task_group_ = task_group; }
+
+  /** @return whether the query's task group was cancelled */
+  auto IsCancelled() const -> bool { return task_group_ != nullptr && task_group_->IsCancelled(); }
+
+  /**
+   * Runs task(thread_idx) for every thread_idx in [0, num_threads) and waits for all of them, on the workers of the
+   * task group if the query has one and on threads of its own otherwise.
+   * @param num_threads the number of tasks, at least 1
+   * @param task the task
+   */
+  void RunParallel(uint32_t num_threads, const std::function<void(uint32_t)> &task) {
+    if (task_group_ != nullptr) {
+      task_group_->RunParallel(num_threads, task);
+    } else {
+      bustub::RunParallel(num_threads, task);
+    }
+  }
+
+  /**
+   * @return the arena of the running query. Its memory is released when the query ends, and operators create their
+   * own arenas as children of it so that their memory counts towards the query's peak usage and limit.
+   */
+  auto GetArena() -> Arena * { return &arena_; }
+
+  /** @param limit the number of bytes all arenas of a query may hold at once */
+  void SetQueryMemoryLimit(size_t limit) { arena_.SetLimit(limit); }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +125,14 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The memory budget of each memory intensive operator, see GetMemoryBudget() */
+  size_t memory_budget_{DEFAULT_EXECUTOR_MEMORY_BUDGET};
+  /** Queries run single threaded unless asked otherwise */
+  uint32_t parallelism_{1};
+  /** The task group of the query, see GetTaskGroup() */
+  TaskGroup *task_group_{nullptr};
+  /** The per-query arena, see GetArena() */
+  Arena arena_{DEFAULT_QUERY_MEMORY_LIMIT};
 };
 
 }  // namespace bustub
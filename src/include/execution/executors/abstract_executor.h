@@ -13,9 +13,13 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
+
+class RuntimeFilter;
+
 /**
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
@@ -46,9 +50,39 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor. Executors that are not vectorized use this row-at-a-time
+   * adapter over Next().
+   * @param[out] batch The batch to fill, its schema is GetOutputSchema(); it is reset first
+   * @return `true` if the batch has rows (possibly none of them selected), `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset();
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->NumRows() > 0;
+  }
+
+  /**
+   * @return `true` if NextBatch() produces columnar batches natively, `false` if it is the row-at-a-time adapter, in
+   * which case pulling tuples through Next() is cheaper than splitting them into columns
+   */
+  virtual auto IsVectorized() const -> bool { return false; }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() -> const Schema * = 0;
 
+  /**
+   * Offer a runtime filter on this executor's output. Filters are dropped by Init(), so they must be pushed after
+   * the executor is initialized.
+   * @param filter The filter, it is owned by the caller and must outlive the scan
+   * @return `true` if the executor applies the filter, `false` if the caller has to filter the rows itself
+   */
+  virtual auto PushRuntimeFilter(RuntimeFilter *filter) -> bool { return false; }
+
   /** @return The executor context in which this executor runs */
   auto GetExecutorContext() -> ExecutorContext * { return exec_ctx_; }
 
@@ -13,14 +13,16 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "common/util/arena.h"
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
+#include "container/hash/open_addressing_hash_table.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/executors/seq_scan_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
 #include "storage/table/tuple.h"
@@ -28,133 +30,180 @@
 
 namespace bustub {
 
+/**
+ * The running state of one aggregate of one group. The state is specialized by the type of the aggregate's input:
+ * COUNT keeps a raw count, SUM/MIN/MAX of integer-like inputs keep an int64_t and of DECIMAL inputs a double.
+ * MIN/MAX of VARCHAR inputs keep their Value next to the state, see SimpleAggregationHashTable.
+ */
+struct AggregateState {
+  union {
+    uint64_t count_;
+    int64_t integer_;
+    double decimal_;
+  };
+  /** Whether a non-NULL input has been combined yet; SUM/MIN/MAX over no such input is NULL */
+  bool has_value_;
+};
+
 /**
  * A simplified hash table that has all the necessary functionality for aggregations.
+ *
+ * The states of a group live in one contiguous array owned by the table, indexed by the group's number, so
+ * combining a row neither allocates nor goes through Value arithmetic. States become Values only when a group is
+ * read through an Iterator.
  */
 class SimpleAggregationHashTable {
  public:
+  /** Maps each group key to the number of the group */
+  using AggregationMap = OpenAddressingHashTable<AggregateKey, uint32_t>;
+
   /**
    * Construct a new SimpleAggregationHashTable instance.
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
+   * @param arena the arena the memory of the groups is charged to, or nullptr if it is not accounted
+   * @throws NotImplementedException if SUM is applied to a non-numeric input
    */
   SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return The initial aggregrate value for this aggregation executor */
-  auto GenerateInitialAggregateValue() -> AggregateValue {
-    std::vector<Value> values{};
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountAggregate:
-          // Count starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::MinAggregate:
-          // Min starts at INT_MAX.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX));
-          break;
-        case AggregationType::MaxAggregate:
-          // Max starts at INT_MIN.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN));
-          break;
-      }
-    }
-    return {values};
-  }
+                             const std::vector<AggregationType> &agg_types, Arena *arena = nullptr);
 
   /**
-   * Combines the input into the aggregation result.
-   * @param[out] result The output aggregate value
-   * @param input The input value
+   * Inserts a value into the hash table and then combines it with the current aggregation.
+   * @param agg_key the key to be inserted
+   * @param agg_val the value to be inserted
    */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountAggregate:
-          // Count increases by one.
-          result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum increases by addition.
-          result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
-          break;
-        case AggregationType::MinAggregate:
-          // Min is just the min.
-          result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
-          break;
-        case AggregationType::MaxAggregate:
-          // Max is just the max.
-          result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
-          break;
-      }
-    }
+  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
+    InsertCombine(std::hash<AggregateKey>()(agg_key), agg_key, agg_val);
   }
 
   /**
    * Inserts a value into the hash table and then combines it with the current aggregation.
+   * @param hash the hash (std::hash<AggregateKey>) of the key
    * @param agg_key the key to be inserted
    * @param agg_val the value to be inserted
    */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
+  void InsertCombine(hash_t hash, const AggregateKey &agg_key, const AggregateValue &agg_val);
+
+  /**
+   * Inserts a row of a child batch into the hash table and combines it with the current aggregation. Aggregates
+   * over a column of the batch read the raw column data instead of evaluating the aggregate expression.
+   * @param hash the hash (std::hash<AggregateKey>) of the key
+   * @param agg_key the group key of the row
+   * @param batch the batch
+   * @param row the row of the batch
+   */
+  void InsertCombine(hash_t hash, const AggregateKey &agg_key, const TupleBatch &batch, uint32_t row);
+
+  /**
+   * Merges partial aggregates into this table; partial counts are added up.
+   * @param other a table over the same aggregates, built from a different part of the input
+   */
+  void Merge(const SimpleAggregationHashTable &other);
+
+  /** @return the number of groups in the table */
+  auto Size() const -> size_t { return ht_.Size(); }
+
+  /** Removes all groups. */
+  void Clear() {
+    ht_.Clear();
+    states_.clear();
+    value_states_.clear();
+    if (arena_ != nullptr) {
+      arena_->Reset();
     }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
   }
 
   /** An iterator over the aggregation hash table */
   class Iterator {
    public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
+    /** Creates an iterator for the aggregate table, positioned at the entry_idx'th group in insertion order. */
+    Iterator(const SimpleAggregationHashTable *table, size_t entry_idx) : table_{table}, entry_idx_{entry_idx} {}
 
     /** @return The key of the iterator */
-    auto Key() -> const AggregateKey & { return iter_->first; }
+    auto Key() -> const AggregateKey & { return table_->ht_.EntryAt(entry_idx_).key_; }
 
-    /** @return The value of the iterator */
-    auto Val() -> const AggregateValue & { return iter_->second; }
+    /** @return The value of the iterator, the aggregates of the group as Values */
+    auto Val() -> AggregateValue { return table_->Finalize(table_->ht_.EntryAt(entry_idx_).value_); }
 
     /** @return The iterator before it is incremented */
     auto operator++() -> Iterator & {
-      ++iter_;
+      ++entry_idx_;
       return *this;
     }
 
     /** @return `true` if both iterators are identical */
-    auto operator==(const Iterator &other) -> bool { return this->iter_ == other.iter_; }
+    auto operator==(const Iterator &other) -> bool {
+      return table_ == other.table_ && entry_idx_ == other.entry_idx_;
+    }
 
     /** @return `true` if both iterators are different */
-    auto operator!=(const Iterator &other) -> bool { return this->iter_ != other.iter_; }
+    auto operator!=(const Iterator &other) -> bool { return !(*this == other); }
 
    private:
-    /** Aggregates map */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
+    /** Aggregates table */
+    const SimpleAggregationHashTable *table_;
+    /** Index of the current group in the map */
+    size_t entry_idx_;
   };
 
   /** @return Iterator to the start of the hash table */
-  auto Begin() -> Iterator { return Iterator{ht_.cbegin()}; }
+  auto Begin() -> Iterator { return Iterator{this, 0}; }
 
   /** @return Iterator to the end of the hash table */
-  auto End() -> Iterator { return Iterator{ht_.cend()}; }
+  auto End() -> Iterator { return Iterator{this, ht_.Size()}; }
 
  private:
-  /** The hash table is just a map from aggregate keys to aggregate values */
-  std::unordered_map<AggregateKey, AggregateValue> ht_{};
+  /** @return the states of the group with the key, creating the group if it is new */
+  auto FindOrInsertGroup(hash_t hash, const AggregateKey &agg_key) -> AggregateState *;
+
+  /**
+   * Combines a non-NULL integer-like input into the state of the i'th aggregate.
+   * @throws Exception OUT_OF_RANGE if a SUM overflows
+   */
+  void CombineInteger(uint32_t i, AggregateState *state, int64_t input) const;
+
+  /** Combines a non-NULL DECIMAL input into the state of the i'th aggregate. */
+  void CombineDecimal(uint32_t i, AggregateState *state, double input) const;
+
+  /** Combines an input Value into the state of the i'th aggregate. */
+  void CombineValue(uint32_t i, AggregateState *state, const Value &input);
+
+  /**
+   * @return the aggregates of a group as Values
+   * @throws Exception OUT_OF_RANGE if a COUNT or an INTEGER SUM does not fit into an INTEGER
+   */
+  auto Finalize(uint32_t group) const -> AggregateValue;
+
+  /** The hash table is just a map from aggregate keys to group numbers */
+  AggregationMap ht_{};
+  /** The states of group g are states_[g * agg_types_.size()] to states_[(g + 1) * agg_types_.size() - 1] */
+  std::vector<AggregateState> states_;
+  /** The Values of the aggregates that keep one, at the index of their state in states_; empty if none does */
+  std::vector<Value> value_states_;
+  /** Whether the i'th aggregate keeps its Value in value_states_ */
+  std::vector<bool> value_states_used_;
+  bool has_value_states_{false};
+  /** Charges the groups to the arena passed to the constructor, nullptr if they are not accounted */
+  std::unique_ptr<Arena> arena_;
   /** The aggregate expressions that we have */
   const std::vector<const AbstractExpression *> &agg_exprs_;
   /** The types of aggregations that we have */
   const std::vector<AggregationType> &agg_types_;
+  /** The return type of each aggregate expression */
+  std::vector<TypeId> input_types_;
+  /** For each aggregate over a column of the child batch its column index, otherwise NO_COLUMN */
+  std::vector<uint32_t> input_columns_;
+  static constexpr uint32_t NO_COLUMN = UINT32_MAX;
 };
 
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * When the child is a sequential scan that runs on several threads, the aggregation runs in two phases: every
+ * scan thread pre-aggregates the batches it produces into thread-local tables, one per hash partition of the
+ * group keys, and then the partitions are merged in parallel, each by a single thread. The groups of a parallel
+ * aggregation come out in no particular order.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -185,6 +234,20 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
+  /** Number of hash partitions of a parallel aggregation is 2^AGG_PARTITION_BITS */
+  static constexpr uint32_t AGG_PARTITION_BITS = 6;
+
+  /** Aggregate all child tuples into a single table on the calling thread. */
+  void BuildSerial();
+
+  /** Aggregate the child tuples with two-phase parallel aggregation, see the class comment. */
+  void BuildParallel(SeqScanExecutor *scan);
+
+  /** @return a new empty table for the aggregates of the plan */
+  auto MakeTable() const -> SimpleAggregationHashTable {
+    return SimpleAggregationHashTable(plan_->GetAggregates(), plan_->GetAggregateTypes(), exec_ctx_->GetArena());
+  }
+
   /** @return The tuple as an AggregateKey */
   auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
     std::vector<Value> keys;
@@ -203,13 +266,25 @@ class AggregationExecutor : public AbstractExecutor {
     return {vals};
   }
 
+  /** @return The row of a child batch as an AggregateKey */
+  auto MakeAggregateKey(const TupleBatch &batch, uint32_t row) const -> AggregateKey {
+    std::vector<Value> keys;
+    keys.reserve(plan_->GetGroupBys().size());
+    for (const auto &expr : plan_->GetGroupBys()) {
+      keys.emplace_back(expr->EvaluateBatchRow(&batch, row));
+    }
+    return {keys};
+  }
+
  private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  SimpleAggregationHashTable table_;
+  /** The aggregation result, a single table or one table per hash partition */
+  std::vector<SimpleAggregationHashTable> tables_;
+  /** The table iter_ is in */
+  size_t table_idx_{0};
   /** Simple aggregation hash table iterator */
   SimpleAggregationHashTable::Iterator iter_;
 };
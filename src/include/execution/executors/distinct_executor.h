@@ -14,10 +14,11 @@
 
 #include <memory>
 #include <utility>
+#include "common/util/arena.h"
 #include "common/util/hash_util.h"
+#include "container/hash/open_addressing_hash_table.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/distinct_plan.h"
-#include "unordered_set"
 
 namespace bustub {
 
@@ -84,6 +85,9 @@ class DistinctExecutor : public AbstractExecutor {
   const DistinctPlanNode *plan_;
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
-  std::unordered_set<DistinctKey> set_;
+  /** The rows emitted so far; only the keys are used */
+  OpenAddressingHashTable<DistinctKey, bool> set_;
+  /** Charges the keys of set_ to the query's memory limit */
+  Arena set_arena_;
 };
 }  // namespace bustub
@@ -12,14 +12,18 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "common/util/arena.h"
 #include "common/util/hash_util.h"
+#include "container/hash/open_addressing_hash_table.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/runtime_filter.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "storage/table/tuple.h"
-#include "unordered_map"
 #include "vector"
 
 namespace bustub {
@@ -42,7 +46,25 @@ struct hash<bustub::HashJoinKey> {
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hybrid hash JOIN on two tables.
+ *
+ * The left child is the build side. Its rows are hashed into NUM_PARTITIONS in-memory partitions. Whenever the
+ * build side exceeds the memory budget of the ExecutorContext, the largest resident partition is written out to a
+ * TmpTupleFile and every later build row of that partition goes to the file as well. Right rows that hash to a
+ * resident partition are joined right away, the others are spilled next to their build partition. Spilled partitions
+ * are joined one at a time after the right child is exhausted; a partition that still does not fit is split again
+ * with different hash bits, up to MAX_PARTITION_LEVEL times (beyond that only duplicate keys remain, so it is joined
+ * in memory anyway).
+ *
+ * If the ExecutorContext allows more than one thread and the left child fits into the memory budget, the join runs as
+ * a parallel radix join instead: the workers hash and radix partition the left child, so that the build side of each
+ * partition fits into a core's L2 cache, and build the hash tables of all partitions. The right child is then read
+ * batch by batch in chunks that fit into what the left child leaves of the budget; each chunk is radix partitioned
+ * the same way and Next() joins its partitions in waves of one partition per thread, returning the output of a
+ * wave before it joins the next one.
+ *
+ * Once the left child is consumed, a Bloom filter over its join keys is offered to the right child as a
+ * RuntimeFilter, so a sequential scan below the probe side drops rows without a join partner before building them.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -70,14 +92,177 @@ class HashJoinExecutor : public AbstractExecutor {
   /** @return The output schema for the join */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
 
+  /** @return The filter pushed into the right child by the last Init(), nullptr if the child did not accept it */
+  auto GetRuntimeFilter() const -> const RuntimeFilter * { return runtime_filter_.get(); }
+
  private:
+  using JoinHashTable = OpenAddressingHashTable<HashJoinKey, std::vector<std::vector<Value>>>;
+  /** Hash table of a radix partition, from join key to the rows of the left side */
+  using RadixHashTable = OpenAddressingHashTable<HashJoinKey, std::vector<uint32_t>>;
+
+  /** Number of partitions each level of partitioning splits its input into */
+  static constexpr uint32_t PARTITION_BITS = 3;
+  static constexpr uint32_t NUM_PARTITIONS = 1U << PARTITION_BITS;
+  /** Spilled partitions are split again at most this many times */
+  static constexpr uint32_t MAX_PARTITION_LEVEL = 4;
+
+  /** Target size of the build side of one radix partition, small enough to stay in a core's L2 cache */
+  static constexpr size_t RADIX_PARTITION_BYTES = 256 * 1024;
+  static constexpr uint32_t MAX_RADIX_BITS = 16;
+
+  /** Both sides of a partition that was written to disk */
+  struct SpilledPartition {
+    std::unique_ptr<TmpTupleFile> build_file_;
+    std::unique_ptr<TmpTupleFile> probe_file_;
+    /** Estimated memory needed to build the partition's hash table */
+    size_t build_memory_{0};
+    /** The partitioning level the partition was produced by, its sub-partitions use the next hash bits */
+    uint32_t level_{0};
+  };
+
+  /** A partition of the first partitioning pass over the left child */
+  struct BuildPartition {
+    JoinHashTable table_;
+    size_t memory_usage_{0};
+    /** Set once the partition has been evicted from memory */
+    std::unique_ptr<SpilledPartition> spilled_;
+  };
+
+  /** One materialized side of the parallel radix join */
+  struct RadixInput {
+    std::vector<Tuple> tuples_;
+    std::vector<HashJoinKey> keys_;
+    std::vector<hash_t> hashes_;
+    /** Row indices grouped by radix partition, rows keep their input order within a partition */
+    std::vector<uint32_t> order_;
+    /** Partition i is order_[offsets_[i], offsets_[i + 1]) */
+    std::vector<size_t> offsets_;
+  };
+
+  /** @return the partition of a hash at the given partitioning level */
+  static auto PartitionOf(hash_t hash, uint32_t level) -> uint32_t;
+
+  /** @return the estimated memory used by a build row */
+  static auto RowMemory(const Tuple &tuple, uint32_t column_count) -> size_t;
+
+  /** @return the join key of a left (build side) tuple */
+  auto LeftKey(const Tuple &tuple) -> HashJoinKey;
+
+  /** @return the join key of a right (probe side) tuple */
+  auto RightKey(const Tuple &tuple) -> HashJoinKey;
+
+  /** Adds a left row to a hash table. */
+  void InsertBuildRow(JoinHashTable *table, hash_t hash, HashJoinKey &&key, const Tuple &tuple);
+
+  /** Adds a left row to its build partition, evicting partitions while the memory budget is exceeded. */
+  void AddBuildRow(const Tuple &tuple);
+
+  /** Consumes the left child into build_partitions_. */
+  void Build();
+
+  /** Offers runtime_filter_, which holds the hashes of all left join keys, to the right child. */
+  void PushRuntimeFilter();
+
+  /**
+   * Pulls the left child into memory for the parallel join.
+   * @param[out] tuples the rows of the left child
+   * @param[out] memory the estimated memory of the rows
+   * @return false if the memory budget was exceeded, the left child is only partially consumed then
+   */
+  auto MaterializeLeft(std::vector<Tuple> *tuples, size_t *memory) -> bool;
+
+  /** Radix partitions the materialized left rows on GetParallelism() threads and builds radix_tables_. */
+  void ParallelJoin(std::vector<Tuple> &&left_tuples, size_t left_memory);
+
+  /**
+   * Reads the next chunk of the right child into radix_right_ and radix partitions it.
+   * @return false if the right child is exhausted
+   */
+  auto ReadProbeChunk() -> bool;
+
+  /**
+   * Joins the next GetParallelism() partitions of the current probe chunk into parallel_output_, reading the next
+   * chunk once all partitions of the current one are joined.
+   * @return false if the join is exhausted
+   */
+  auto NextParallelWave() -> bool;
+
+  /** Computes keys and hashes of a side and groups its rows into 2^radix_bits partitions. */
+  void RadixPartition(RadixInput *input, bool is_left, uint32_t radix_bits, uint32_t num_threads);
+
+  /** Probes one radix partition of the current probe chunk. */
+  void JoinRadixPartition(size_t partition, std::vector<Tuple> *out);
+
+  /** @return the output row for a pair of matching tuples */
+  auto MakeOutputTuple(const Tuple &left_tuple, const Tuple &right_tuple) -> Tuple;
+
+  /** Writes the largest resident partition to disk. */
+  void EvictLargestPartition();
+
+  /** @return a new empty spilled partition at the given level */
+  auto MakeSpilledPartition(uint32_t level) -> std::unique_ptr<SpilledPartition>;
+
+  /** Either builds hash_table_ from a spilled partition or splits it into pending_partitions_. */
+  void LoadSpilledPartition(std::unique_ptr<SpilledPartition> &&partition);
+
+  /**
+   * Advances the probe side to the next right tuple that has matching build rows.
+   * @return false if the join is exhausted
+   */
+  auto NextProbeMatch() -> bool;
+
   /** The NestedLoopJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_child_executor_;
   std::unique_ptr<AbstractExecutor> right_child_executor_;
-  std::unordered_map<HashJoinKey, std::vector<std::vector<Value>>> hash_table_;
-  std::vector<std::vector<Value>> outer_buffer_table_;
+  /** The partitions of the left child, only resident partitions are probed while reading the right child */
+  std::vector<BuildPartition> build_partitions_;
+  /** Memory used by all resident build partitions */
+  size_t build_memory_{0};
+  /** Charges the rows and hash tables held by the join to the query's memory limit */
+  Arena table_arena_;
+  /** Bloom filter over the left join keys that the right child applies, filled while building */
+  std::unique_ptr<RuntimeFilter> runtime_filter_;
+  /** Whether the right child has been consumed and the join works on spilled partitions */
+  bool probing_spilled_{false};
+  /** Spilled partitions waiting to be joined */
+  std::deque<std::unique_ptr<SpilledPartition>> pending_partitions_;
+  /** The spilled partition being joined, its build side is loaded into hash_table_ */
+  std::unique_ptr<SpilledPartition> current_partition_;
+  /** Build side rows of current_partition_ grouped by join key */
+  JoinHashTable hash_table_;
+  /** The next page of current_partition_'s probe file to read */
+  size_t probe_page_idx_{0};
+  /** Right tuples of the current probe page and the position of the next one */
+  std::vector<Tuple> probe_tuples_;
+  size_t probe_tuple_idx_{0};
+  /** The right tuple being joined */
+  Tuple right_tuple_;
+  /** The build side rows matching right_tuple_ */
+  const std::vector<std::vector<Value>> *outer_buffer_table_{nullptr};
   uint32_t next_pos_{0};
+  /** Whether the join ran as a parallel radix join */
+  bool parallel_{false};
+  /** The left child of the parallel join, radix partitioned */
+  RadixInput radix_left_;
+  /** The hash tables of the radix partitions of radix_left_ */
+  std::vector<RadixHashTable> radix_tables_;
+  uint32_t radix_bits_{0};
+  /** The chunk of the right child being joined, radix partitioned */
+  RadixInput radix_right_;
+  /** Memory a chunk of the right child may take, and the memory of the current chunk */
+  size_t probe_chunk_budget_{0};
+  size_t probe_chunk_memory_{0};
+  /** The batch of the right child being read into chunks and the position of its next row */
+  std::unique_ptr<TupleBatch> probe_batch_;
+  uint32_t probe_batch_row_{0};
+  /** The first radix partition of the current chunk that is not joined yet */
+  size_t next_radix_partition_{0};
+  /** Output of the current wave of the parallel join, one vector per radix partition */
+  std::vector<std::vector<Tuple>> parallel_output_;
+  size_t parallel_output_memory_{0};
+  size_t output_partition_idx_{0};
+  size_t output_tuple_idx_{0};
 };
 
 }  // namespace bustub
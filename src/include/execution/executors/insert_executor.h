@@ -27,6 +27,9 @@ namespace bustub {
  *
  * Unlike UPDATE and DELETE, inserted values may either be
  * embedded in the plan itself or be pulled from a child executor.
+ *
+ * Rows are inserted a batch at a time: each batch goes into the table heap with TableHeap::InsertTuples(), which
+ * latches every page once, and its keys go into each index with a single Index::InsertEntries() call.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -43,26 +46,39 @@ class InsertExecutor : public AbstractExecutor {
   void Init() override;
 
   /**
-   * Yield the next tuple from the insert.
+   * Insert all rows; the first call does all the work.
    * @param[out] tuple The next tuple produced by the insert
    * @param[out] rid The next tuple RID produced by the insert
-   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   * @return `false`, the insert produces no tuples
    *
    * NOTE: InsertExecutor::Next() does not use the `tuple` out-parameter.
    * NOTE: InsertExecutor::Next() does not use the `rid` out-parameter.
    */
-  auto Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool override;
+  auto Next([[maybe_unused]] Tuple *tuple, [[maybe_unused]] RID *rid) -> bool override;
 
   /** @return The output schema for the insert */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
 
  private:
+  /** Number of raw values inserted per batch */
+  static constexpr size_t RAW_INSERT_BATCH_SIZE = TupleBatch::DEFAULT_BATCH_SIZE;
+
+  /**
+   * Insert a batch of tuples into the table and its indexes. The tuples the table took before rejecting the batch
+   * are added to the indexes as well.
+   * @param tuples the tuples
+   * @return false if the table heap rejected the batch
+   */
+  auto InsertBatch(const std::vector<Tuple> &tuples) -> bool;
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
   TableInfo* table_info_;
   size_t next_insert_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   std::vector<IndexInfo *> index_array_;
+  /** The rids of the batch being inserted */
+  std::vector<RID> rids_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/merge_join_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinExecutor joins two children sorted on their join keys by advancing whichever side has the smaller key.
+ *
+ * Keys are compared as ascending normalized keys (see NormalizedKey), so integer keys of different widths compare
+ * by value. The right tuples of the current key are buffered as a run and replayed for every left tuple with that
+ * key, which is all the memory the join needs; duplicates on both sides produce their full cross product.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new MergeJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The merge join plan to be executed
+   * @param left_child The child executor that produces tuples for the left side of join, sorted on its key
+   * @param right_child The child executor that produces tuples for the right side of join, sorted on its key
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
+
+  /** Initialize the join */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the join.
+   * @param[out] tuple The next tuple produced by the join
+   * @param[out] rid Unused
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   * @throws Exception if a child turns out not to be sorted on its join key
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the join */
+  auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
+
+ private:
+  /** One side of the join: its current tuple and the tuple's key */
+  struct Input {
+    AbstractExecutor *executor_;
+    const AbstractExpression *key_expr_;
+    Tuple tuple_;
+    std::string key_;
+    bool exhausted_{false};
+  };
+
+  /** Move a side to its next tuple with a non-NULL key, checking that the keys do not decrease. */
+  static void Advance(Input *input);
+
+  /** The merge join plan node to be executed */
+  const MergeJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  Input left_;
+  Input right_;
+  /** The right tuples whose key equals run_key_ */
+  std::vector<Tuple> run_;
+  std::string run_key_;
+  /** The run tuple to join with the current left tuple next, run_.size() when not joining */
+  size_t run_pos_{0};
+};
+
+}  // namespace bustub
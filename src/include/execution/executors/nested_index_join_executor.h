@@ -14,14 +14,15 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/nested_index_join_plan.h"
+#include "execution/runtime_filter.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
@@ -29,6 +30,20 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ *
+ * The predicate must be an equality between an expression over the outer tuple and a column of the inner table,
+ * whose value is used as the key of the inner index. Output and predicate expressions with tuple index 1 refer to
+ * the columns of the inner table.
+ *
+ * Outer tuples are read in batches that fill the executor memory budget. The keys of a batch are sorted so that
+ * every distinct key probes the index once and neighbouring probes touch neighbouring index pages, and the matching
+ * RIDs are then sorted so that inner tuples are fetched page by page, each inner tuple once per batch.
+ *
+ * If the outer child is a scan of a table at least MIN_OUTER_TO_INNER_PAGES times as large as the inner table, and the
+ * inner table fits into the memory budget, Init() also builds a Bloom filter over the inner index keys and offers it
+ * to the outer child as a RuntimeFilter, so outer rows without a join partner are dropped where they are read
+ * instead of being buffered and probed. Otherwise the inner table is not scanned for this, so that the cost of the
+ * join follows the number of outer rows and matches rather than the size of the inner table.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -47,8 +62,51 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /** @return The filter pushed into the outer child by the last Init(), nullptr if none was built or accepted */
+  auto GetRuntimeFilter() const -> const RuntimeFilter * { return runtime_filter_.get(); }
+
  private:
+  /** An inner RID found for the outer tuple at outer_batch_[outer_idx_] */
+  struct Match {
+    RID rid_;
+    uint32_t outer_idx_;
+  };
+
+  /** Fixed memory accounted per buffered outer tuple besides its data and key */
+  static constexpr size_t TUPLE_OVERHEAD = sizeof(Tuple) + sizeof(std::string);
+
+  /**
+   * Buffer the next batch of outer tuples and look up the inner RIDs matching them.
+   * @return `false` if the outer child is exhausted
+   */
+  auto NextOuterBatch() -> bool;
+
+  /** Builds runtime_filter_ over the index keys of the inner table and offers it to the outer child, if worthwhile. */
+  void PushRuntimeFilter();
+
+  /** How many times as many pages as the inner table the outer scan needs before the inner table is scanned */
+  static constexpr size_t MIN_OUTER_TO_INNER_PAGES = 4;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  const TableInfo *inner_table_info_;
+  const IndexInfo *index_info_;
+  /** The side of the predicate evaluated on outer tuples to build index keys */
+  const AbstractExpression *outer_key_expr_;
+  /** The current batch of outer tuples */
+  std::vector<Tuple> outer_batch_;
+  /** An outer tuple read past the end of the previous batch */
+  Tuple next_outer_tuple_;
+  bool has_next_outer_{false};
+  /** The matches of the current batch in RID order, and the next one to output */
+  std::vector<Match> matches_;
+  size_t match_pos_{0};
+  /** The most recently fetched inner tuple; inner_valid_ is false if it could not be fetched */
+  Tuple inner_tuple_;
+  RID inner_rid_;
+  bool inner_valid_{false};
+  /** Bloom filter over the inner index keys that the outer child applies */
+  std::unique_ptr<RuntimeFilter> runtime_filter_;
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -23,7 +24,11 @@
 namespace bustub {
 
 /**
- * NestedLoopJoinExecutor executes a nested-loop JOIN on two tables.
+ * NestedLoopJoinExecutor executes a block nested-loop JOIN on two tables.
+ *
+ * The left (outer) child is read in batches that fill the executor memory budget, and the right (inner) child is
+ * scanned once per batch instead of once per outer tuple. Every inner tuple is matched against the whole batch in
+ * a tight loop, so the output is ordered by batch, then by inner tuple, then by outer tuple.
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -54,16 +59,37 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
   /** @return The output schema for the insert */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
 
+  /** @return the number of times the inner child has been scanned, which is the number of outer batches */
+  auto GetNumInnerScans() const -> size_t { return num_inner_scans_; }
+
  private:
+  /** Fixed memory accounted per buffered outer tuple besides its data */
+  static constexpr size_t TUPLE_OVERHEAD = sizeof(Tuple);
+
+  /**
+   * Buffer the next batch of outer tuples and restart the inner child.
+   * @return `false` if the outer child is exhausted
+   */
+  auto NextOuterBatch() -> bool;
+
   /** The NestedLoopJoin plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
   mutable const AbstractExpression *predicate_{nullptr};
   bool is_alloc_{false};
-  bool is_selected_;
-  Tuple left_tuple_;
-  RID left_rid_;
+  /** Holds the data of the current outer batch */
+  Arena outer_arena_;
+  /** The current batch of outer tuples, viewing outer_arena_ */
+  std::vector<Tuple> outer_batch_;
+  /** An outer tuple read past the end of the previous batch */
+  Tuple next_outer_tuple_;
+  bool has_next_outer_{false};
+  /** The current inner tuple and the next outer tuple of the batch to match it against */
+  Tuple inner_tuple_;
+  bool has_inner_{false};
+  size_t outer_pos_{0};
+  size_t num_inner_scans_{0};
 };
 
 }  // namespace bustub
@@ -12,17 +12,34 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/runtime_filter.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * When the executor context allows more than one thread, the scan is morsel-driven: worker threads claim small
+ * page ranges from a MorselDispenser, filter and project the tuples of those pages into thread-local batches and
+ * hand the batches on. A parent that can consume batches on the scan threads calls ParallelScan() directly; any
+ * other parent pulls through Next()/NextBatch(), which drain a bounded exchange the workers fill in the
+ * background. Rows of a parallel scan come out in no particular order.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -34,6 +51,7 @@ class SeqScanExecutor : public AbstractExecutor {
   SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
 
   ~SeqScanExecutor() override;
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -45,15 +63,94 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch from the sequential scan. Output columns are decoded straight into the batch and
+   * runtime filters narrow its selection. A parallel scan replaces the batch with one produced by a worker,
+   * which holds up to TupleBatch::DEFAULT_BATCH_SIZE rows.
+   * @param[out] batch The batch to fill
+   * @return `true` if the batch has rows, `false` if the scan is exhausted
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** @return `true`, the scan fills the columns of its batches directly */
+  auto IsVectorized() const -> bool override { return true; }
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); }
 
+  /** Make a running ParallelScan() return early, the workers stop after the page they are reading. */
+  void CancelParallelScan() { cancelled_ = true; }
+
+  /**
+   * Apply a join's runtime filter before output tuples are built. Only filters whose key is one of the output
+   * columns are accepted.
+   */
+  auto PushRuntimeFilter(RuntimeFilter *filter) -> bool override;
+
+  /**
+   * Scan the whole table on several threads and hand every non-empty output batch to sink on the thread that
+   * produced it. Returns once the table is exhausted or the scan is cancelled.
+   * @param num_threads the number of threads, including the calling one
+   * @param sink called as sink(thread_idx, batch); must be safe to call from several threads at once
+   */
+  void ParallelScan(uint32_t num_threads, const std::function<void(uint32_t, const TupleBatch &)> &sink);
+
+  /** @return whether the scan runs on several threads, which is when Next()/NextBatch() pull from workers */
+  auto UseParallelScan() const -> bool;
+
+  /** @return the number of pages of the scanned table, which bounds how much the scan reads */
+  auto GetNumTablePages() const -> size_t { return table_info_->table_->GetNumPages(); }
+
  private:
+  /** Batches the exchange holds before the workers wait for the parent to catch up */
+  static constexpr size_t MAX_EXCHANGE_BATCHES = 16;
+
+  /** Append the output columns of a table tuple as a new row of the batch. */
+  void AppendOutputRow(const Tuple &table_tuple, TupleBatch *batch);
+
+  /** Narrow the selection of a batch of output rows by the runtime filters. */
+  void ApplyRuntimeFilters(TupleBatch *batch);
+
+  /** Wait for the next batch of the exchange, starting the workers on first use. @return false once exhausted */
+  auto PopExchangeBatch(TupleBatch *batch) -> bool;
+
+  /** Called by the workers, waits while the exchange is full. */
+  void PushExchangeBatch(const TupleBatch &batch);
+
+  /** Cancel the workers of the exchange, wait for them and drop the batches not consumed yet. */
+  void StopParallelScan();
+
+  /** @return whether the tuple satisfies the scan predicate, using the compiled predicate when there is one */
+  auto MatchesPredicate(const Tuple &table_tuple) -> bool;
+
+  /** @return `false` if a runtime filter rejects the tuple */
+  auto PassesRuntimeFilters(const Tuple &table_tuple) -> bool;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   mutable const AbstractExpression *predicate_;
+  /** predicate_ compiled against the table schema, nullptr if it has to be interpreted */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
   TableInfo *table_info_;
   TableIterator iter_;
   bool is_alloc_ = false;
+  /** The output schema lists the table's columns in order, so table tuples are passed on without re-serializing */
+  bool identity_projection_ = false;
+  /** Pushed down runtime filters, with their keys rewritten to expressions over the table schema */
+  std::vector<std::pair<RuntimeFilter *, const AbstractExpression *>> runtime_filters_;
+
+  /** Runs ParallelScan() feeding the exchange, see PopExchangeBatch() */
+  std::thread producer_;
+  std::mutex exchange_latch_;
+  std::condition_variable exchange_not_empty_;
+  std::condition_variable exchange_not_full_;
+  std::deque<TupleBatch> exchange_;
+  bool producer_done_{false};
+  /** The error that stopped the producer, rethrown to the parent */
+  std::exception_ptr producer_error_;
+  std::atomic<bool> cancelled_{false};
+  /** The exchange batch Next() is returning rows from */
+  TupleBatch current_batch_;
+  uint32_t current_row_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/loser_tree.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/table/tmp_tuple_file.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortExecutor sorts the tuples of its child (ORDER BY) with an external merge sort.
+ *
+ * Tuples are buffered together with their normalized sort keys (see NormalizedKey) and sorted in memory by a
+ * single memcmp per comparison. When the buffer outgrows the executor memory budget it is sorted and written out
+ * as a run of temporary pages. At the end the runs are merged with a loser tree, reading one page per run at a
+ * time; if there are more runs than the budget has pages for, groups of runs are first merged into longer runs.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new SortExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The sort plan to be executed
+   * @param child_executor The child executor from which tuples are obtained
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /** Initialize the sort, this consumes the whole child */
+  void Init() override;
+
+  /**
+   * Yield the next tuple in sort order.
+   * @param[out] tuple The next tuple produced by the sort
+   * @param[out] rid The RID of the tuple, only valid if the input fit in memory
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the sort */
+  auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); }
+
+  /** @return the number of runs written to temporary pages, 0 if the input was sorted in memory */
+  auto GetNumSpilledRuns() const -> size_t { return num_spilled_runs_; }
+
+ private:
+  /** Position in a run that is being merged, holding the run's current page in memory */
+  struct RunCursor {
+    TmpTupleFile *run_;
+    size_t page_idx_;
+    std::vector<Tuple> page_;
+    size_t pos_;
+
+    /** @return whether every tuple of the run has been consumed */
+    auto Exhausted() const -> bool { return pos_ == page_.size(); }
+
+    /** Moves to the next tuple of the run, reading its next page when needed. */
+    void Advance();
+  };
+
+  /** Orders run cursors by their current keys; exhausted runs go last */
+  struct RunCursorLess {
+    const std::vector<RunCursor> *cursors_;
+    auto operator()(size_t a, size_t b) const -> bool;
+  };
+
+  /** Fixed memory accounted per buffered tuple besides its key and data */
+  static constexpr size_t TUPLE_OVERHEAD = sizeof(Tuple) + sizeof(std::string_view) + sizeof(uint32_t);
+
+  /** Sort the buffered tuples by their keys, into order_. */
+  void SortBuffer();
+
+  /** Sort the buffered tuples and write them out as a new run. */
+  void SpillBuffer();
+
+  /** @return the most runs merged at once, one page of each is held in memory */
+  auto MaxMergeFanIn() const -> size_t;
+
+  /** Start merging the runs [begin, end) of runs_. */
+  void StartMerge(size_t begin, size_t end);
+
+  /** @return the next tuple of the current merge in run format, false once every run is consumed */
+  auto NextMerged(Tuple *run_tuple) -> bool;
+
+  /** The sort plan node to be executed */
+  const SortPlanNode *plan_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** Holds the data of the buffered tuples and keys, released whenever the buffer is spilled */
+  Arena buffer_arena_;
+  /** Buffered tuples and their keys, both viewing buffer_arena_, and the order of the buffer once sorted */
+  std::vector<std::string_view> keys_;
+  std::vector<Tuple> tuples_;
+  std::vector<uint32_t> order_;
+  size_t buffer_memory_{0};
+  /** The next position of order_ to output when the input fit in memory */
+  size_t next_idx_{0};
+
+  /** Sorted runs written to temporary pages */
+  std::vector<std::unique_ptr<TmpTupleFile>> runs_;
+  size_t num_spilled_runs_{0};
+  /** State of the current merge */
+  std::vector<RunCursor> cursors_;
+  std::unique_ptr<LoserTree<RunCursorLess>> loser_tree_;
+};
+
+}  // namespace bustub
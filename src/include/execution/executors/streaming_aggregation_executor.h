@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// streaming_aggregation_executor.h
+//
+// Identification: src/include/execution/executors/streaming_aggregation_executor.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/executors/aggregation_executor.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * StreamingAggregationExecutor executes an aggregation over a child whose tuples arrive sorted on the GROUP BY
+ * columns. Each group is complete once the key changes, so it is emitted right away and only the states of the
+ * current group are kept in memory. ExecutorFactory picks it over AggregationExecutor when CanStream() holds.
+ */
+class StreamingAggregationExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new StreamingAggregationExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The aggregation plan to be executed
+   * @param child The child executor, producing tuples sorted on the group by columns
+   */
+  StreamingAggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child);
+
+  /** Initialize the aggregation */
+  void Init() override;
+
+  /**
+   * Yield the next group of the aggregation.
+   * @param[out] tuple The next tuple produced by the aggregation
+   * @param[out] rid Unused
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the aggregation */
+  auto GetOutputSchema() -> const Schema * override { return plan_->OutputSchema(); };
+
+  /**
+   * @param plan an aggregation plan
+   * @return whether the child of the plan produces its tuples sorted on all the group by columns, so that the
+   * aggregation can stream
+   */
+  static auto CanStream(const AggregationPlanNode *plan) -> bool;
+
+ private:
+  /** @return The row of a child batch as an AggregateKey */
+  auto MakeAggregateKey(const TupleBatch &batch, uint32_t row) const -> AggregateKey;
+
+  /**
+   * Build the output tuple of the current group and start an empty one.
+   * @return `false` if the group does not satisfy the HAVING clause
+   */
+  auto EmitGroup(Tuple *tuple) -> bool;
+
+  /** The aggregation plan node */
+  const AggregationPlanNode *plan_;
+  /** The child executor, whose tuples are sorted on the group by columns */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** Holds the current group only */
+  SimpleAggregationHashTable group_;
+  /** The current batch of child tuples and the next row of it to aggregate */
+  TupleBatch batch_;
+  uint32_t batch_pos_{0};
+  bool child_exhausted_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.h
+//
+// Identification: src/include/execution/executors/topn_executor.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TopNExecutor returns the first N tuples of its child in sort order in a single pass and O(N) memory.
+ *
+ * The best N tuples seen so far are kept in a max-heap on their normalized keys, so the heap top is the tuple an
+ * incoming one has to beat. The key of an incoming tuple is encoded one sort column at a time and compared with
+ * the heap top after every column; most tuples are rejected after the first column, without evaluating the rest
+ * of their key or copying them.
+ *
+ * ExecutorFactory also uses it for a LimitPlanNode directly over a SortPlanNode.
+ */
+class TopNExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new TopNExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The top-n plan to be executed
+   * @param child_executor The child executor from which tuples are obtained
+   */
+  TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /**
+   * Construct a new TopNExecutor instance for a limit over a sort.
+   * @param exec_ctx The executor context
+   * @param limit_plan The limit plan
+   * @param sort_plan The sort plan, the child of the limit plan
+   * @param child_executor The child executor of the sort plan
+   */
+  TopNExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *limit_plan, const SortPlanNode *sort_plan,
+               std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /** Initialize the top-n, this consumes the whole child */
+  void Init() override;
+
+  /**
+   * Yield the next tuple in sort order.
+   * @param[out] tuple The next tuple produced by the top-n
+   * @param[out] rid The next tuple RID produced by the top-n
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the top-n */
+  auto GetOutputSchema() -> const Schema * override { return output_schema_; }
+
+ private:
+  /** @return whether the key of slot a sorts before the key of slot b */
+  auto KeyLess(uint32_t a, uint32_t b) const -> bool { return keys_[a] < keys_[b]; }
+
+  /**
+   * Encode the key of a tuple, unless it cannot enter the heap.
+   * @param[out] key the normalized key of the tuple
+   * @return `false` if the heap is full and the tuple does not sort before its top
+   */
+  auto EncodeIfAdmitted(const Tuple &tuple, std::string *key) const -> bool;
+
+  const Schema *output_schema_;
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys_;
+  size_t n_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** Slots of the retained tuples and their keys */
+  std::vector<std::string> keys_;
+  std::vector<Tuple> tuples_;
+  /** Max-heap of slot numbers, ordered by key; sorted ascending once the child is consumed */
+  std::vector<uint32_t> heap_;
+  /** The next position of heap_ to output */
+  size_t next_idx_{0};
+};
+
+}  // namespace bustub
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -59,6 +60,18 @@ class AbstractExpression {
   virtual auto EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const
       -> Value = 0;
 
+  /**
+   * Returns the value obtained by evaluating one row of a batch. The default implementation materializes the row,
+   * expressions that can read the columns directly override it.
+   * @param batch The batch, its schema is the schema Evaluate() would be called with
+   * @param row The row of the batch
+   * @return The value obtained by evaluating the row
+   */
+  virtual auto EvaluateBatchRow(const TupleBatch *batch, uint32_t row) const -> Value {
+    Tuple tuple = batch->GetTuple(row);
+    return Evaluate(&tuple, batch->GetSchema());
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpression * { return children_[child_idx]; }
 
@@ -48,6 +48,10 @@ class ColumnValueExpression : public AbstractExpression {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
 
+  auto EvaluateBatchRow(const TupleBatch *batch, uint32_t row) const -> Value override {
+    return batch->GetValue(col_idx_, row);
+  }
+
   auto GetTupleIdx() const -> uint32_t { return tuple_idx_; }
   auto GetColIdx() const -> uint32_t { return col_idx_; }
 
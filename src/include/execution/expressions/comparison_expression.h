@@ -54,6 +54,15 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  auto EvaluateBatchRow(const TupleBatch *batch, uint32_t row) const -> Value override {
+    Value lhs = GetChildAt(0)->EvaluateBatchRow(batch, row);
+    Value rhs = GetChildAt(1)->EvaluateBatchRow(batch, row);
+    return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
+  }
+
+  /** @return the comparison this expression performs */
+  auto GetComparisonType() const -> ComparisonType { return comp_type_; }
+
  private:
   auto PerformComparison(const Value &lhs, const Value &rhs) const -> CmpBool {
     switch (comp_type_) {
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.h
+//
+// Identification: src/include/execution/expressions/compiled_predicate.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * CompiledPredicate is a predicate that runs directly on the serialized bytes of a tuple.
+ *
+ * Compile() turns a constant or a comparison between a numeric column (TINYINT, SMALLINT, INTEGER, BIGINT, DECIMAL)
+ * and a constant or another column of the same type into a single function pointer, specialized at compile time on
+ * the column's storage type, the comparison domain (int64_t or double) and the operator. Evaluating it reads the
+ * columns at their fixed offsets and never builds a Value or goes through Type dispatch.
+ *
+ * A comparison with a NULL column is not satisfied, as in SQL. (The interpreted path turns it into a NULL boolean
+ * whose GetAs<bool>() is not well defined.)
+ */
+class CompiledPredicate {
+ public:
+  /**
+   * Compiles a predicate.
+   * @param expr the predicate
+   * @param schema the schema of the tuples the predicate is evaluated on
+   * @return the compiled predicate, or nullptr if the expression is not supported and has to be interpreted
+   */
+  static auto Compile(const AbstractExpression *expr, const Schema *schema) -> std::unique_ptr<CompiledPredicate>;
+
+  /** @return the predicate's result for a tuple in the schema it was compiled for */
+  auto Evaluate(const Tuple &tuple) const -> bool { return fn_(*this, tuple.GetData()); }
+
+ private:
+  using EvalFn = bool (*)(const CompiledPredicate &, const char *);
+
+  CompiledPredicate() = default;
+
+  template <typename T>
+  static auto Load(const char *data, uint32_t offset) -> T;
+  template <typename T>
+  static auto IsNullValue(T value) -> bool;
+  template <typename D>
+  auto Constant() const -> D;
+
+  template <typename T, typename D, typename Op>
+  static auto ColumnConstant(const CompiledPredicate &predicate, const char *data) -> bool;
+  template <typename T, typename Op>
+  static auto ColumnColumn(const CompiledPredicate &predicate, const char *data) -> bool;
+  static auto ConstantResult(const CompiledPredicate &predicate, const char *data) -> bool;
+
+  /** @return the specialization for a column of storage type T compared to a constant in domain D */
+  template <typename T, typename D>
+  static auto SelectColumnConstant(ComparisonType comp_type) -> EvalFn;
+  /** @return the specialization for two columns of storage type T */
+  template <typename T>
+  static auto SelectColumnColumn(ComparisonType comp_type) -> EvalFn;
+
+  EvalFn fn_{nullptr};
+  uint32_t left_offset_{0};
+  uint32_t right_offset_{0};
+  int64_t integer_constant_{0};
+  double decimal_constant_{0};
+  bool result_{false};
+};
+
+}  // namespace bustub
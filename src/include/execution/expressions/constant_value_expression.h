@@ -37,6 +37,8 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  auto EvaluateBatchRow(const TupleBatch *batch, uint32_t row) const -> Value override { return val_; }
+
  private:
   Value val_;
 };
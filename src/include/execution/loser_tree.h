@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// loser_tree.h
+//
+// Identification: src/include/execution/loser_tree.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * LoserTree picks the smallest head among k sorted sources for a k-way merge (tree of losers, Knuth 5.4.1).
+ *
+ * Every internal node remembers the loser of the match played there, so after the winner's source advances only
+ * the log2(k) matches on its path to the root are replayed, one comparison each, instead of the two per level
+ * a binary heap needs.
+ *
+ * Less(a, b) must tell whether the current head of source a sorts before the head of source b; an exhausted source
+ * sorts after every other source.
+ */
+template <typename Less>
+class LoserTree {
+ public:
+  /**
+   * Builds the tree over the current heads of the sources.
+   * @param num_sources the number of sources, at least 1
+   * @param less the comparison of the heads of two sources
+   */
+  LoserTree(size_t num_sources, Less less) : num_sources_(num_sources), less_(std::move(less)) {
+    // Every node starts out holding a virtual source that beats everything, so that adding the real sources one
+    // at a time leaves exactly the real losers in the tree.
+    nodes_.assign(num_sources_, num_sources_);
+    for (size_t source = num_sources_; source-- > 0;) {
+      Replay(source);
+    }
+  }
+
+  /** @return the source whose head is the smallest */
+  auto Winner() const -> size_t { return nodes_[0]; }
+
+  /** Re-establishes the winner after the head of the current winner has advanced. */
+  void Next() { Replay(nodes_[0]); }
+
+ private:
+  /** @return whether source a wins against source b */
+  auto Beats(size_t a, size_t b) -> bool {
+    if (a == num_sources_ || b == num_sources_) {
+      return a == num_sources_;
+    }
+    return less_(a, b);
+  }
+
+  /** Plays source's way up from its leaf to the root. */
+  void Replay(size_t source) {
+    auto winner = source;
+    for (auto node = (source + num_sources_) / 2; node > 0; node /= 2) {
+      if (Beats(nodes_[node], winner)) {
+        std::swap(nodes_[node], winner);
+      }
+    }
+    nodes_[0] = winner;
+  }
+
+  size_t num_sources_;
+  Less less_;
+  /** nodes_[0] is the winner, nodes_[1..num_sources_) the losers of the matches at the internal nodes */
+  std::vector<size_t> nodes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_dispenser.h
+//
+// Identification: src/include/execution/morsel_dispenser.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * MorselDispenser hands out the pages of a table as small ranges ("morsels") to the threads of a parallel scan.
+ *
+ * Threads grab the next morsel whenever they finish one, so a thread that is slowed down simply takes fewer
+ * morsels and the work stays balanced without any up-front partitioning.
+ */
+class MorselDispenser {
+ public:
+  /** Pages per morsel, small enough to balance the threads and large enough to amortize the shared cursor */
+  static constexpr size_t DEFAULT_MORSEL_PAGES = 4;
+
+  /**
+   * Creates a dispenser over a snapshot of page ids.
+   * @param page_ids the pages to hand out
+   * @param morsel_pages the number of pages per morsel
+   */
+  explicit MorselDispenser(std::vector<page_id_t> page_ids, size_t morsel_pages = DEFAULT_MORSEL_PAGES)
+      : page_ids_(std::move(page_ids)), morsel_pages_(morsel_pages) {}
+
+  /**
+   * Claims the next morsel. Safe to call from several threads at once.
+   * @param[out] begin the index of the first page of the morsel
+   * @param[out] end one past the index of the last page of the morsel
+   * @return false if every page has been handed out
+   */
+  auto Next(size_t *begin, size_t *end) -> bool {
+    auto first = cursor_.fetch_add(morsel_pages_);
+    if (first >= page_ids_.size()) {
+      return false;
+    }
+    *begin = first;
+    *end = std::min(first + morsel_pages_, page_ids_.size());
+    return true;
+  }
+
+  /** @return the id of the page_idx'th page */
+  auto GetPageId(size_t page_idx) const -> page_id_t { return page_ids_[page_idx]; }
+
+ private:
+  const std::vector<page_id_t> page_ids_;
+  const size_t morsel_pages_;
+  std::atomic<size_t> cursor_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/execution/normalized_key.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * NormalizedKey encodes sort keys into byte strings whose lexicographic (memcmp) order is the sort order, so rows
+ * are compared with one memcmp instead of one virtual Value comparison per key column.
+ *
+ * Each value is a NULL marker byte followed by a fixed-width big-endian encoding for numbers, or by the escaped
+ * bytes of a VARCHAR and a terminator. All bytes of a DESC key are inverted.
+ */
+class NormalizedKey {
+ public:
+  /**
+   * Appends the encoding of one value to a key.
+   * @param value the value
+   * @param order_by_type the direction of the key
+   * @param[out] key the key to append to
+   */
+  static void Append(const Value &value, OrderByType order_by_type, std::string *key);
+
+  /**
+   * Encodes the sort keys of a tuple.
+   * @param tuple the tuple
+   * @param schema the schema of the tuple
+   * @param order_bys the sort keys, most significant first
+   * @return the normalized key
+   */
+  static auto Encode(const Tuple &tuple, const Schema *schema,
+                     const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys) -> std::string;
+};
+
+}  // namespace bustub
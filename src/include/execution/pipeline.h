@@ -0,0 +1,258 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline.h
+//
+// Identification: src/include/execution/pipeline.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/util/arena.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/executors/aggregation_executor.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * An operator of a push-based pipeline. Its input pushes batches into Consume(), and the operator pushes its own
+ * output into the next operator of the pipeline, so a whole pipeline runs as nested loops over one batch without
+ * returning to a driver in between. Pipeline breakers (hash builds, aggregations) end a pipeline: they keep what
+ * they consume and a later pipeline reads it through a PipelineSource.
+ *
+ * Consume() is called concurrently from every thread of a pipeline, each passing its own thread_idx, so operators
+ * keep per-thread state for everything they modify.
+ */
+class PushOperator {
+ public:
+  virtual ~PushOperator() = default;
+
+  /**
+   * Prepare for a run of the pipeline.
+   * @param num_threads the number of threads that will push batches, thread_idx ranges over [0, num_threads)
+   */
+  virtual void Open(uint32_t num_threads) {}
+
+  /**
+   * Consume the selected rows of a batch.
+   * @param thread_idx the thread pushing the batch
+   * @param batch the batch, only valid during the call
+   */
+  virtual void Consume(uint32_t thread_idx, const TupleBatch &batch) = 0;
+
+  /** Called once every thread has pushed its last batch, before the next operator is closed. */
+  virtual void Close() {}
+
+  /** @return whether no more input is needed, e.g. because a LIMIT is satisfied further down the pipeline */
+  virtual auto IsDone() const -> bool { return next_ != nullptr && next_->IsDone(); }
+
+  /** @return the operator this one pushes its output into, nullptr for the sink ending the pipeline */
+  auto GetNext() const -> PushOperator * { return next_; }
+
+  /** @param next the operator to push output into */
+  void SetNext(PushOperator *next) { next_ = next; }
+
+ protected:
+  PushOperator *next_{nullptr};
+};
+
+/** Produces the input of a pipeline and pushes it into the pipeline's first operator. */
+class PipelineSource {
+ public:
+  virtual ~PipelineSource() = default;
+
+  /**
+   * Push all rows into an operator.
+   * @param target the first operator of the pipeline, already opened with GetNumThreads() threads
+   */
+  virtual void Produce(PushOperator *target) = 0;
+
+  /** @return the number of threads Produce() pushes from */
+  virtual auto GetNumThreads() const -> uint32_t { return 1; }
+};
+
+/** A source and the chain of operators it pushes into, which ends at a sink. */
+class Pipeline {
+ public:
+  Pipeline(PipelineSource *source, PushOperator *head) : source_(source), head_(head) {}
+
+  /** Open the operators, push the whole input through them and close them in pipeline order. */
+  void Run();
+
+ private:
+  PipelineSource *source_;
+  PushOperator *head_;
+};
+
+/** Scans a table, on GetParallelism() threads if the scan allows it. */
+class ScanSource : public PipelineSource {
+ public:
+  /** @param scan the scan, it is initialized by Produce() */
+  explicit ScanSource(std::unique_ptr<SeqScanExecutor> &&scan) : scan_(std::move(scan)) {}
+
+  void Produce(PushOperator *target) override;
+
+  auto GetNumThreads() const -> uint32_t override;
+
+ private:
+  std::unique_ptr<SeqScanExecutor> scan_;
+};
+
+/** Pulls batches from an executor tree, for plan nodes the pipeline engine does not run itself. */
+class ExecutorSource : public PipelineSource {
+ public:
+  /** @param executor the root of the tree, it is initialized by Produce() */
+  explicit ExecutorSource(std::unique_ptr<AbstractExecutor> &&executor) : executor_(std::move(executor)) {}
+
+  void Produce(PushOperator *target) override;
+
+ private:
+  std::unique_ptr<AbstractExecutor> executor_;
+};
+
+/** Builds the hash table of a hash join from the left side; the pipeline breaker of the build side. */
+class HashBuildSink : public PushOperator {
+ public:
+  using JoinHashTable = OpenAddressingHashTable<HashJoinKey, std::vector<std::vector<Value>>>;
+
+  /**
+   * @param plan the join
+   * @param arena the arena the memory of the build rows is charged to
+   */
+  HashBuildSink(const HashJoinPlanNode *plan, Arena *arena) : plan_(plan), arena_(arena) {}
+
+  void Open(uint32_t num_threads) override;
+
+  void Consume(uint32_t thread_idx, const TupleBatch &batch) override;
+
+  /** Moves the rows collected by every thread into the hash table. */
+  void Close() override;
+
+  /** @return the build rows grouped by join key, complete once the build pipeline has run */
+  auto GetTable() const -> const JoinHashTable & { return table_; }
+
+ private:
+  /** A left row with its key, collected by one thread */
+  struct BuildRow {
+    hash_t hash_;
+    HashJoinKey key_;
+    std::vector<Value> values_;
+  };
+
+  const HashJoinPlanNode *plan_;
+  Arena *arena_;
+  std::vector<std::vector<BuildRow>> local_rows_;
+  /** Charge the rows collected by each thread, and later held by table_, to arena_ */
+  std::vector<std::unique_ptr<Arena>> local_arenas_;
+  JoinHashTable table_;
+};
+
+/** Probes the table of a HashBuildSink with right rows and pushes the joined rows. */
+class HashProbeOperator : public PushOperator {
+ public:
+  /**
+   * @param plan the join, its output columns must all be ColumnValueExpressions (see CanProbe())
+   * @param build the build side of the join
+   */
+  HashProbeOperator(const HashJoinPlanNode *plan, const HashBuildSink *build) : plan_(plan), build_(build) {}
+
+  /** @return whether the output of a join can be assembled by the probe */
+  static auto CanProbe(const HashJoinPlanNode *plan) -> bool;
+
+  void Open(uint32_t num_threads) override;
+
+  void Consume(uint32_t thread_idx, const TupleBatch &batch) override;
+
+ private:
+  const HashJoinPlanNode *plan_;
+  const HashBuildSink *build_;
+  /** Output batch of each thread, pushed whenever it fills up and at the end of every input batch */
+  std::vector<std::unique_ptr<TupleBatch>> outputs_;
+};
+
+/** Aggregates its input into per-thread tables that are merged on Close(); the pipeline breaker of a GROUP BY. */
+class AggregationSink : public PushOperator {
+ public:
+  /**
+   * @param plan the aggregation
+   * @param arena the arena the memory of the groups is charged to
+   */
+  AggregationSink(const AggregationPlanNode *plan, Arena *arena) : plan_(plan), arena_(arena) {}
+
+  void Open(uint32_t num_threads) override;
+
+  void Consume(uint32_t thread_idx, const TupleBatch &batch) override;
+
+  void Close() override;
+
+  /** @return the plan of the aggregation */
+  auto GetPlan() const -> const AggregationPlanNode * { return plan_; }
+
+  /** @return all groups, complete once the pipeline has run */
+  auto GetTable() -> SimpleAggregationHashTable * { return tables_[0].get(); }
+
+ private:
+  const AggregationPlanNode *plan_;
+  Arena *arena_;
+  /** One table per thread, tables_[0] holds the result after Close() */
+  std::vector<std::unique_ptr<SimpleAggregationHashTable>> tables_;
+};
+
+/** Emits the groups of an AggregationSink that pass the HAVING clause. */
+class AggregationSource : public PipelineSource {
+ public:
+  explicit AggregationSource(AggregationSink *sink) : sink_(sink) {}
+
+  void Produce(PushOperator *target) override;
+
+ private:
+  AggregationSink *sink_;
+};
+
+/** Passes on the first rows of its input until the limit is reached, then reports IsDone(). */
+class LimitOperator : public PushOperator {
+ public:
+  explicit LimitOperator(size_t limit) : limit_(limit) {}
+
+  void Open(uint32_t num_threads) override { count_ = 0; }
+
+  void Consume(uint32_t thread_idx, const TupleBatch &batch) override;
+
+  auto IsDone() const -> bool override { return count_ >= limit_ || PushOperator::IsDone(); }
+
+ private:
+  size_t limit_;
+  /** Rows claimed so far by all threads */
+  std::atomic<size_t> count_{0};
+};
+
+/** Collects the rows of the final pipeline as tuples. */
+class ResultSink : public PushOperator {
+ public:
+  /** @param result_set where the rows are appended on Close(), may be nullptr */
+  explicit ResultSink(std::vector<Tuple> *result_set) : result_set_(result_set) {}
+
+  void Open(uint32_t num_threads) override;
+
+  void Consume(uint32_t thread_idx, const TupleBatch &batch) override;
+
+  void Close() override;
+
+ private:
+  std::vector<Tuple> *result_set_;
+  std::vector<std::vector<Tuple>> local_results_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_execution_engine.h
+//
+// Identification: src/include/execution/pipeline_execution_engine.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_context.h"
+#include "execution/pipeline.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * PipelineExecutionEngine executes query plans push-based, as an alternative to the pull-based ExecutionEngine.
+ *
+ * The plan is cut into pipelines at its breakers: the build side of a hash join and the input of an aggregation
+ * each end a pipeline. Within a pipeline the source pushes batches through the fused scan, probe and limit
+ * operators into the breaker or the result, with one virtual call per operator and batch instead of per tuple.
+ * Pipelines run one after another, each on as many threads as its source provides: a sequential scan source runs
+ * on GetParallelism() threads through SeqScanExecutor::ParallelScan().
+ *
+ * Plan nodes without a push operator (sorts, nested loop joins, DML, ...) and the children below them run as a
+ * regular executor tree whose batches become the source of a pipeline. Hash joins and aggregations of this engine
+ * keep their state in memory; plans that need spilling should use ExecutionEngine.
+ */
+class PipelineExecutionEngine {
+ public:
+  /**
+   * Construct a new PipelineExecutionEngine instance.
+   * @param bpm The buffer pool manager used by the execution engine
+   * @param txn_mgr The transaction manager used by the execution engine
+   * @param catalog The catalog used by the execution engine
+   */
+  PipelineExecutionEngine(BufferPoolManager *bpm, TransactionManager *txn_mgr, Catalog *catalog)
+      : bpm_{bpm}, txn_mgr_{txn_mgr}, catalog_{catalog} {}
+
+  DISALLOW_COPY_AND_MOVE(PipelineExecutionEngine);
+
+  /**
+   * Execute a query plan.
+   * @param plan The query plan to execute
+   * @param result_set The set of tuples produced by executing the plan
+   * @param txn The transaction context in which the query executes
+   * @param exec_ctx The executor context in which the query executes
+   * @return `true` if execution of the query plan succeeds, `false` otherwise
+   */
+  auto Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
+               ExecutorContext *exec_ctx) -> bool;
+
+ private:
+  /** The pipelines of one query and everything they point to */
+  struct QueryPipelines {
+    std::vector<std::unique_ptr<PipelineSource>> sources_;
+    std::vector<std::unique_ptr<PushOperator>> operators_;
+    /** In execution order, every pipeline comes after the pipelines whose breakers it reads */
+    std::vector<Pipeline> pipelines_;
+  };
+
+  /**
+   * Add the pipelines that compute plan and push its output into consumer.
+   * @param plan the plan node
+   * @param consumer the operator the rows of plan are pushed into
+   * @param exec_ctx the executor context of the query
+   * @param query the pipelines being built
+   */
+  static void BuildPipelines(const AbstractPlanNode *plan, PushOperator *consumer, ExecutorContext *exec_ctx,
+                             QueryPipelines *query);
+
+  /** The buffer pool manager used during query execution */
+  [[maybe_unused]] BufferPoolManager *bpm_;
+  /** The transaction manager used during query execution */
+  [[maybe_unused]] TransactionManager *txn_mgr_;
+  /** The catalog used during query execution */
+  [[maybe_unused]] Catalog *catalog_;
+};
+
+}  // namespace bustub
@@ -31,7 +31,10 @@ enum class PlanType {
   Distinct,
   NestedLoopJoin,
   NestedIndexJoin,
-  HashJoin
+  HashJoin,
+  Sort,
+  TopN,
+  MergeJoin
 };
 
 /**
@@ -65,6 +68,12 @@ class AbstractPlanNode {
   /** @return the type of this plan node */
   virtual auto GetType() const -> PlanType = 0;
 
+  /**
+   * @return the output columns the tuples of this plan node are sorted on, most significant first, or an empty list
+   * if the tuples come out in no particular order
+   */
+  virtual auto GetOutputOrdering() const -> std::vector<uint32_t> { return {}; }
+
  private:
   /**
    * The schema for the output of this plan node. In the volcano model, every plan node will spit out tuples,
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_plan.h
+//
+// Identification: src/include/execution/plans/sort_plan.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** OrderByType is the direction of an ORDER BY key. NULLs sort before every other value in ascending order. */
+enum class OrderByType { ASC, DESC };
+
+/**
+ * @param order_bys sort keys, most significant first
+ * @return the leading sort keys that are plain columns of the first input, as an output ordering
+ */
+inline auto OrderByColumns(const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys)
+    -> std::vector<uint32_t> {
+  std::vector<uint32_t> ordering;
+  for (const auto &[order_by_type, expr] : order_bys) {
+    auto column = dynamic_cast<const ColumnValueExpression *>(expr);
+    if (column == nullptr || column->GetTupleIdx() != 0) {
+      break;
+    }
+    ordering.push_back(column->GetColIdx());
+  }
+  return ordering;
+}
+
+/**
+ * SortPlanNode sorts the tuples of its child on a list of keys (ORDER BY). The output schema is the child's schema,
+ * the tuples are passed through unchanged.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new SortPlanNode instance.
+   * @param output_schema The output schema, the same as the child's
+   * @param child The child plan from which tuples are obtained
+   * @param order_bys The sort keys, most significant first, evaluated against the child's output schema
+   */
+  SortPlanNode(const Schema *output_schema, const AbstractPlanNode *child,
+               std::vector<std::pair<OrderByType, const AbstractExpression *>> &&order_bys)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)) {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::Sort; }
+
+  /** @return The child plan node */
+  auto GetChildPlan() const -> const AbstractPlanNode * {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Sort should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return The sort keys, most significant first */
+  auto GetOrderBys() const -> const std::vector<std::pair<OrderByType, const AbstractExpression *>> & {
+    return order_bys_;
+  }
+
+  /** @return The leading sort keys that are plain output columns */
+  auto GetOutputOrdering() const -> std::vector<uint32_t> override { return OrderByColumns(order_bys_); }
+
+ private:
+  /** The sort keys */
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_plan.h
+//
+// Identification: src/include/execution/plans/topn_plan.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/sort_plan.h"
+
+namespace bustub {
+
+/**
+ * TopNPlanNode returns the first N tuples of its child in sort order (ORDER BY ... LIMIT N). The output schema is
+ * the child's schema, the tuples are passed through unchanged.
+ */
+class TopNPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new TopNPlanNode instance.
+   * @param output_schema The output schema, the same as the child's
+   * @param child The child plan from which tuples are obtained
+   * @param order_bys The sort keys, most significant first, evaluated against the child's output schema
+   * @param n The number of tuples to return
+   */
+  TopNPlanNode(const Schema *output_schema, const AbstractPlanNode *child,
+               std::vector<std::pair<OrderByType, const AbstractExpression *>> &&order_bys, size_t n)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)), n_(n) {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::TopN; }
+
+  /** @return The child plan node */
+  auto GetChildPlan() const -> const AbstractPlanNode * {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "TopN should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return The sort keys, most significant first */
+  auto GetOrderBys() const -> const std::vector<std::pair<OrderByType, const AbstractExpression *>> & {
+    return order_bys_;
+  }
+
+  /** @return The number of tuples to return */
+  auto GetN() const -> size_t { return n_; }
+
+  /** @return The leading sort keys that are plain output columns */
+  auto GetOutputOrdering() const -> std::vector<uint32_t> override { return OrderByColumns(order_bys_); }
+
+ private:
+  /** The sort keys */
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys_;
+  /** The number of tuples to return */
+  size_t n_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// runtime_filter.h
+//
+// Identification: src/include/execution/runtime_filter.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "common/util/hash_util.h"
+#include "container/hash/bloom_filter.h"
+#include "execution/expressions/abstract_expression.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * RuntimeFilter is a semi-join filter a join builds over the keys of one input and pushes into the executor
+ * producing the other input, so rows without a join partner are dropped where they are read.
+ *
+ * The filter is owned by the join. The executor applying it counts how many rows it checked and eliminated.
+ * Check() may be called by several scan threads at once.
+ */
+class RuntimeFilter {
+ public:
+  /**
+   * Creates an empty RuntimeFilter.
+   * @param key_expr the join key, evaluated against the output schema of the executor the filter is pushed into
+   * @param expected_keys the number of keys the filter is sized for
+   */
+  RuntimeFilter(const AbstractExpression *key_expr, size_t expected_keys)
+      : key_expr_(key_expr), bloom_filter_(expected_keys) {}
+
+  /** @param hash the hash (HashUtil::HashValue) of a key of the build side */
+  void Insert(hash_t hash) { bloom_filter_.Insert(hash); }
+
+  /**
+   * Checks a key of the filtered side and updates the counters.
+   * @return false if the key has no join partner, NULL keys never have one
+   */
+  auto Check(const Value &key) -> bool {
+    rows_checked_.fetch_add(1, std::memory_order_relaxed);
+    if (key.IsNull() || !bloom_filter_.MayContain(HashUtil::HashValue(&key))) {
+      rows_eliminated_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  /** @return the join key expression over the filtered executor's output schema */
+  auto GetKeyExpression() const -> const AbstractExpression * { return key_expr_; }
+
+  /** @return the number of rows checked against the filter */
+  auto GetRowsChecked() const -> uint64_t { return rows_checked_; }
+
+  /** @return the number of rows the filter dropped */
+  auto GetRowsEliminated() const -> uint64_t { return rows_eliminated_; }
+
+ private:
+  const AbstractExpression *key_expr_;
+  BloomFilter bloom_filter_;
+  std::atomic<uint64_t> rows_checked_{0};
+  std::atomic<uint64_t> rows_eliminated_{0};
+};
+
+}  // namespace bustub
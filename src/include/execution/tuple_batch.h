@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnVector holds the values of one column of a TupleBatch.
+ *
+ * Integer, boolean and timestamp columns are stored as int64_t and decimal columns as double, so operators can
+ * work on plain arrays. Variable length columns keep their Values.
+ */
+class ColumnVector {
+ public:
+  explicit ColumnVector(TypeId type) : type_(type) {}
+
+  /** @return the type of the column */
+  auto GetType() const -> TypeId { return type_; }
+
+  /** @return whether the column is stored in GetIntegers() */
+  auto IsInteger() const -> bool { return type_ != TypeId::DECIMAL && type_ != TypeId::VARCHAR; }
+
+  /** @return the number of values in the column */
+  auto Size() const -> size_t { return nulls_.size(); }
+
+  /** Appends a value, it must have the column's type. */
+  void Append(const Value &value);
+
+  /** @return the row'th value */
+  auto GetValue(uint32_t row) const -> Value;
+
+  /** @return whether the row'th value is NULL */
+  auto IsNull(uint32_t row) const -> bool { return nulls_[row] != 0; }
+
+  /** @return the values of an integer, boolean or timestamp column, NULLs are stored as 0 */
+  auto GetIntegers() const -> const std::vector<int64_t> & { return integers_; }
+
+  /** @return the values of a decimal column, NULLs are stored as 0 */
+  auto GetDecimals() const -> const std::vector<double> & { return decimals_; }
+
+  /** Removes all values. */
+  void Clear();
+
+ private:
+  TypeId type_;
+  std::vector<int64_t> integers_;
+  std::vector<double> decimals_;
+  std::vector<Value> varlens_;
+  std::vector<uint8_t> nulls_;
+};
+
+/**
+ * TupleBatch is a batch of rows in columnar form, produced by AbstractExecutor::NextBatch().
+ *
+ * A batch can also hold whole tuples instead (AppendRow()), for rows that are only handed on as tuples, e.g. the
+ * result rows of an executor that is not vectorized. Such a batch has no columns and is read through GetValue(),
+ * GetTuple() and GetRID() only.
+ *
+ * The batch has a row for every appended tuple. An optional selection vector restricts the batch to a subset of
+ * its rows, so filters can drop rows without moving column data. Consumers iterate over the selected rows only:
+ *
+ *   for (uint32_t i = 0; i < batch.NumSelected(); i++) { auto row = batch.SelectedRow(i); ... }
+ */
+class TupleBatch {
+ public:
+  /** Rows per batch, enough to amortize a virtual call per batch while the columns stay in cache */
+  static constexpr uint32_t DEFAULT_BATCH_SIZE = 1024;
+
+  /**
+   * Creates an empty TupleBatch.
+   * @param schema the schema of the rows
+   * @param capacity the maximum number of rows
+   */
+  explicit TupleBatch(const Schema *schema, uint32_t capacity = DEFAULT_BATCH_SIZE);
+
+  /** Removes all rows and the selection. */
+  void Reset();
+
+  /** @return the schema of the rows */
+  auto GetSchema() const -> const Schema * { return schema_; }
+
+  /** @return the maximum number of rows */
+  auto Capacity() const -> uint32_t { return capacity_; }
+
+  /** @return the number of rows, selected or not */
+  auto NumRows() const -> uint32_t { return static_cast<uint32_t>(rids_.size()); }
+
+  /** @return whether no more rows can be appended */
+  auto IsFull() const -> bool { return NumRows() >= capacity_; }
+
+  /** @return the col_idx'th column */
+  auto GetColumn(uint32_t col_idx) -> ColumnVector & { return columns_[col_idx]; }
+
+  /** @return the col_idx'th column */
+  auto GetColumn(uint32_t col_idx) const -> const ColumnVector & { return columns_[col_idx]; }
+
+  /** Appends the values of a tuple in the batch's schema. */
+  void AppendTuple(const Tuple &tuple, RID rid);
+
+  /** Appends a tuple in the batch's schema as it is, without splitting it into columns; see the class comment. */
+  void AppendRow(Tuple &&tuple, RID rid) {
+    tuples_.emplace_back(std::move(tuple));
+    rids_.push_back(rid);
+  }
+
+  /** Finishes a row whose values were appended to every column directly. */
+  void CommitRow(RID rid) { rids_.push_back(rid); }
+
+  /** @return the number of selected rows */
+  auto NumSelected() const -> uint32_t {
+    return has_selection_ ? static_cast<uint32_t>(selection_.size()) : NumRows();
+  }
+
+  /** @return the index of the i'th selected row */
+  auto SelectedRow(uint32_t i) const -> uint32_t { return has_selection_ ? selection_[i] : i; }
+
+  /** Restricts the batch to the given rows, which must be a subset of the currently selected rows. */
+  void SetSelection(std::vector<uint32_t> &&selection) {
+    selection_ = std::move(selection);
+    has_selection_ = true;
+  }
+
+  /** @return the value of a column in a row */
+  auto GetValue(uint32_t col_idx, uint32_t row) const -> Value {
+    return tuples_.empty() ? columns_[col_idx].GetValue(row) : tuples_[row].GetValue(schema_, col_idx);
+  }
+
+  /** @return the RID of a row */
+  auto GetRID(uint32_t row) const -> RID { return rids_[row]; }
+
+  /** @return a row as a Tuple, with the row's RID */
+  auto GetTuple(uint32_t row) const -> Tuple;
+
+ private:
+  const Schema *schema_;
+  uint32_t capacity_;
+  std::vector<ColumnVector> columns_;
+  std::vector<RID> rids_;
+  /** The rows of a batch filled by AppendRow(), empty for a columnar batch */
+  std::vector<Tuple> tuples_;
+  std::vector<uint32_t> selection_;
+  bool has_selection_{false};
+};
+
+}  // namespace bustub
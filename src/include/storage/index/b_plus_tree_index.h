@@ -30,6 +30,9 @@ class BPlusTreeIndex : public Index {
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  /** Inserts the entries in key order, so consecutive inserts descend to the same or neighbouring leaves. */
+  void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
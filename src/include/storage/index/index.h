@@ -159,6 +159,18 @@ class Index {
    */
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  /**
+   * Insert a batch of entries into the index. Indexes whose inserts benefit from locality override this, e.g. to
+   * insert the entries in key order.
+   * @param entries The index keys and the RIDs associated with them
+   * @param transaction The transaction context
+   */
+  virtual void InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &[key, rid] : entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
   /**
    * Delete an index entry by key.
    * @param key The index key
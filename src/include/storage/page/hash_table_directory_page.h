@@ -90,12 +90,12 @@ class HashTableDirectoryPage {
    * DirectoryIndex = Hash(key) & GLOBAL_DEPTH_MASK
    *
    * where GLOBAL_DEPTH_MASK is a mask with exactly GLOBAL_DEPTH 1's from LSB
-   * upwards.  For example, global depth 3 corresponds to 0x00000007 in a 32-bit
-   * representation.
+   * upwards.  For example, global depth 3 corresponds to 0x0000000000000007 in a
+   * 64-bit representation, so the mask can be applied to a full 64-bit hash.
    *
    * @return mask of global_depth 1's and the rest 0's (with 1's from LSB upwards)
    */
-  uint32_t GetGlobalDepthMask();
+  uint64_t GetGlobalDepthMask();
 
   /**
    * GetLocalDepthMask - same as global depth mask, except it
@@ -104,7 +104,7 @@ class HashTableDirectoryPage {
    * @param bucket_idx the index to use for looking up local depth
    * @return mask of local 1's and the rest 0's (with 1's from LSB upwards)
    */
-  uint32_t GetLocalDepthMask(uint32_t bucket_idx);
+  uint64_t GetLocalDepthMask(uint32_t bucket_idx);
 
   /**
    * Get the global depth of the hash table directory
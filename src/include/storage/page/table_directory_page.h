@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_directory_page.h
+//
+// Identification: src/include/storage/page/table_directory_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * TableDirectoryPage stores a part of the page directory of a table heap: the ids of its table pages in chain
+ * order. The directory pages of a table form a chain of their own, whose first page is recorded in the first table
+ * page (see TablePage::GetDirectoryPageId()).
+ *
+ * TableDirectoryPage format:
+ *
+ * Sizes are in bytes.
+ * | PageId (4) | LSN (4) | NextDirectoryPageId (4) | PageCount (4) | TablePageId_1 (4) | TablePageId_2 (4) | ... |
+ */
+class TableDirectoryPage : public Page {
+ public:
+  /** Number of table page ids a directory page holds */
+  static constexpr uint32_t CAPACITY = (PAGE_SIZE - 16) / sizeof(page_id_t);
+
+  void Init(page_id_t page_id) {
+    lsn_t lsn = INVALID_LSN;
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    SetNextPageId(INVALID_PAGE_ID);
+    SetPageCount(0);
+  }
+
+  /** @return the page id stored in the header, which matches the id the page was fetched with if it is valid */
+  auto GetDirectoryPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the next page of the directory, INVALID_PAGE_ID for the last one */
+  auto GetNextPageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the next page of the directory. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table page ids on this page */
+  auto GetPageCount() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_PAGE_COUNT); }
+
+  /** @return the idx'th table page id on this page */
+  auto GetTablePageId(uint32_t idx) -> page_id_t {
+    return *reinterpret_cast<page_id_t *>(GetData() + SIZE_HEADER + idx * sizeof(page_id_t));
+  }
+
+  /**
+   * Append a table page id.
+   * @param page_id the table page
+   * @return false if the page is full
+   */
+  auto Append(page_id_t page_id) -> bool {
+    auto count = GetPageCount();
+    if (count == CAPACITY) {
+      return false;
+    }
+    memcpy(GetData() + SIZE_HEADER + count * sizeof(page_id_t), &page_id, sizeof(page_id_t));
+    SetPageCount(count + 1);
+    return true;
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_PAGE_COUNT = 12;
+  static constexpr size_t SIZE_HEADER = 16;
+
+  void SetPageCount(uint32_t count) { memcpy(GetData() + OFFSET_PAGE_COUNT, &count, sizeof(uint32_t)); }
+};
+
+}  // namespace bustub
@@ -40,6 +40,12 @@ namespace bustub {
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ *  Deleting a tuple frees its slot, which the next insert reuses, but leaves a hole among the inserted tuples unless
+ *  the tuple borders the free space. Compact() moves the tuples back together when an insert or update needs the
+ *  space of the holes.
+ *
+ *  The first page of a table has no previous page; its PrevPageId holds the first page of the table's page
+ *  directory instead (see TableDirectoryPage).
  */
 class TablePage : public Page {
  public:
@@ -72,6 +78,12 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the first page of the table's page directory, only valid on the first page of a table */
+  auto GetDirectoryPageId() -> page_id_t { return GetPrevPageId(); }
+
+  /** Set the first page of the table's page directory, only on the first page of a table. */
+  void SetDirectoryPageId(page_id_t directory_page_id) { SetPrevPageId(directory_page_id); }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -123,6 +135,16 @@ class TablePage : public Page {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
 
+  /**
+   * Read a tuple from a table without copying it.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple a view of the tuple, valid while this page stays pinned, latched and unmodified
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  auto GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -138,6 +160,16 @@ class TablePage : public Page {
    */
   auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
 
+  /**
+   * Compact the page: move the tuples together at the end of the page, so the holes left by deleted tuples join the
+   * free space, and drop the empty slots at the end of the slot array. RIDs stay valid.
+   * @return the bytes added to the free space
+   */
+  auto Compact() -> uint32_t;
+
+  /** @return the size of the largest tuple InsertTuple() can fit on this page, compacting it if needed, 0 if none */
+  auto GetMaxInsertSize() -> uint32_t;
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -171,6 +203,15 @@ class TablePage : public Page {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
   }
 
+  /** @return the bytes of the holes left among the inserted tuples by deleted tuples */
+  auto GetFragmentedSpace() -> uint32_t;
+
+  /** @return the first slot that holds no tuple, GetTupleCount() if every slot does */
+  auto FindFreeSlot() -> uint32_t;
+
+  /** Drop the empty slots at the end of the slot array. */
+  void TrimFreeSlots();
+
   /** @return tuple offset at slot slot_num */
   auto GetTupleOffsetAtSlot(uint32_t slot_num) -> uint32_t {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
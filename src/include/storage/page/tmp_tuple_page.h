@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
@@ -21,16 +23,61 @@ namespace bustub {
 class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
+    lsn_t lsn = INVALID_LSN;
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t));
+    SetFreeSpacePointer(page_size);
+  }
+
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** Overwrites the page id stored in the header, used when a page buffered in memory is written out. */
+  void SetTablePageId(page_id_t page_id) { memcpy(GetData(), &page_id, sizeof(page_id_t)); }
+
+  /**
+   * Appends a tuple to the page.
+   * @param tuple the tuple to insert
+   * @param[out] out where the tuple was stored
+   * @return false if the page does not have enough free space for the tuple
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    uint32_t size = tuple.GetLength();
+    uint32_t free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_HEADER + sizeof(uint32_t) + size) {
+      return false;
+    }
+    free_space_pointer -= sizeof(uint32_t) + size;
+    memcpy(GetData() + free_space_pointer, &size, sizeof(uint32_t));
+    memcpy(GetData() + free_space_pointer + sizeof(uint32_t), tuple.GetData(), size);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  /**
+   * Reads a tuple back.
+   * @param offset the offset returned by Insert
+   * @param[out] tuple the tuple stored at offset
+   */
+  void Get(size_t offset, Tuple *tuple) { tuple->DeserializeFrom(GetData() + offset); }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /** @return the offset of the most recently inserted tuple, or PAGE_SIZE if the page is empty */
+  auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /** @return the offset of the tuple inserted before the one at offset, or PAGE_SIZE after the first tuple */
+  auto GetNextTupleOffset(size_t offset) -> size_t {
+    return offset + sizeof(uint32_t) + *reinterpret_cast<uint32_t *>(GetData() + offset);
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+  static constexpr size_t SIZE_HEADER = 12;
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
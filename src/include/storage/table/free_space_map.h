@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks how many bytes each page of a table heap has free, so an insert can go straight to a page
+ * with room instead of trying every page of the chain.
+ *
+ * Free space is kept as one byte per page, in units of PAGE_SIZE / 256 rounded down, so a page the map reports as
+ * big enough always is, unless its entry is stale. The bytes are the leaves of a max tree whose inner nodes hold
+ * the largest value below them, which finds a page with enough space in O(log #pages).
+ *
+ * The map is a hint: callers re-check the page under its latch and report the free space they saw with Update().
+ */
+class FreeSpaceMap {
+ public:
+  /** Returned by FindPage() if no page has enough space */
+  static constexpr size_t NO_PAGE = SIZE_MAX;
+
+  /**
+   * Add a page to the map.
+   * @param page_id the page
+   * @param free_bytes the bytes free on the page
+   */
+  void AddPage(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Record the free space of a page of the map.
+   * @param page_id the page
+   * @param free_bytes the bytes free on the page
+   */
+  void Update(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Find a page with enough free space, preferring the first one at or after start so that callers starting at
+   * different positions spread out over different pages.
+   * @param free_bytes the bytes needed
+   * @param start where to start looking, taken modulo the number of pages
+   * @return the page, or INVALID_PAGE_ID if no page has enough space
+   */
+  auto FindPage(uint32_t free_bytes, size_t start) -> page_id_t;
+
+  /** @return the number of pages in the map */
+  auto GetNumPages() -> size_t;
+
+ private:
+  /** Free bytes per unit of a category */
+  static constexpr uint32_t CATEGORY_BYTES = PAGE_SIZE / 256;
+
+  /** @return the first leaf at or after start whose category is at least category, NO_PAGE if there is none */
+  auto FindFirst(size_t node, size_t node_begin, size_t node_end, size_t start, uint8_t category) const -> size_t;
+
+  /** Set a leaf and fix the maxima above it. */
+  void SetLeaf(size_t leaf, uint8_t category);
+
+  std::mutex latch_;
+  /** The pages in the order they were added */
+  std::vector<page_id_t> page_ids_;
+  /** Position of each page in page_ids_ */
+  std::unordered_map<page_id_t, size_t> page_index_;
+  /** The max tree: node i has children 2i and 2i+1, the leaves start at capacity_ */
+  std::vector<uint8_t> tree_;
+  /** The number of leaves, a power of two */
+  size_t capacity_{0};
+};
+
+}  // namespace bustub
@@ -12,9 +12,15 @@
 
 #pragma once
 
+#include <functional>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "common/task_scheduler.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -23,6 +29,12 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * Besides the chain, the heap keeps a page directory: the ids of its pages in chain order, persisted in
+ * TableDirectoryPages and cached in memory, so finding the n-th page, counting pages or splitting a scan takes no
+ * walk along the chain, and opening a table reads only the directory. The heap grows by extents of EXTENT_SIZE
+ * pages allocated back to back. A free space map on top of the directory lets inserts go straight to a page with
+ * room.
  */
 class TableHeap {
   friend class TableIterator;
@@ -51,7 +63,8 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into a page with enough space, which the free space map points to, or into a new page appended
+   * to the table. If the tuple is too large (>= page_size), return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +72,18 @@ class TableHeap {
    */
   auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
 
+  /**
+   * Bulk insert tuples into the table. Unlike InsertTuple(), this does not look for free space in earlier pages: it
+   * fills the last page of the table and then appends new pages, pinning and latching each page once for all the
+   * tuples that go into it. If any tuple is too large, nothing is inserted. If the insert fails part way, e.g. because
+   * no page could be fetched, the transaction is aborted and the tuples inserted so far stay in its write set.
+   * @param tuples tuples to insert
+   * @param[out] rids the rids of the inserted tuples, in the order of tuples; a prefix of tuples if the insert failed
+   * @param txn the transaction performing the insert
+   * @return true iff all tuples were inserted
+   */
+  auto InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool;
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -108,11 +133,81 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return a snapshot of the ids of the pages of this table, in chain order */
+  auto GetPageIds() -> std::vector<page_id_t>;
+
+  /** @return the number of pages of this table */
+  auto GetNumPages() -> size_t;
+
+  /**
+   * @param page_idx the position of a page in the chain
+   * @return the id of the page, INVALID_PAGE_ID if the table has no more than page_idx pages
+   */
+  auto GetPageId(size_t page_idx) -> page_id_t;
+
+  /**
+   * Visit all live tuples of one page of this table, in slot order, without copying them.
+   * @param page_id the page to read, one of GetPageIds()
+   * @param txn transaction performing the read
+   * @param visitor called with a view of every tuple; the view is only valid during the call, since the page is
+   * pinned and read latched just for the duration of the scan
+   * @return false if the page could not be fetched
+   */
+  auto ScanPage(page_id_t page_id, Transaction *txn, const std::function<void(const Tuple &)> &visitor) -> bool;
+
+  /**
+   * Compact every page of this table (see TablePage::Compact()) and record the reclaimed space in the free space
+   * map. Inserts and updates compact a page themselves when they need the space, so vacuuming only gets ahead of
+   * them: it is meant to run in the background, on a task group with a low priority so that workers only pick it up
+   * while no query needs them. Each page is latched only while it is compacted.
+   * @param group the task group the pages are compacted on, extent by extent; nullptr to compact on the calling thread
+   * @return the bytes added to the free space of the pages
+   */
+  auto Vacuum(TaskGroup *group = nullptr) -> size_t;
+
  private:
+  /** Number of pages the heap grows by at a time */
+  static constexpr size_t EXTENT_SIZE = 8;
+
+  /**
+   * Load the page directory persisted for an existing table, and check that it covers the whole page chain.
+   * @param directory_page_id the first directory page
+   * @return false if the table has no directory or it does not match the chain
+   */
+  auto LoadDirectory(page_id_t directory_page_id) -> bool;
+
+  /** Persist page_ids_ in new directory pages and record the first one in the first table page. */
+  void WriteDirectory();
+
+  /** Append a page to the persisted directory. Requires page_ids_latch_. */
+  void AppendToDirectory(page_id_t page_id);
+
+  /**
+   * Append an extent of empty pages to the chain and publish them in the directory and the free space map.
+   * @param last_page the last page of the chain, write latched by the caller
+   * @param txn the transaction growing the heap
+   * @return false if not a single page could be allocated
+   */
+  auto AllocateExtent(TablePage *last_page, Transaction *txn) -> bool;
+
+  /**
+   * Append an extent to the chain, unless another thread did so since the caller found no page with enough space.
+   * @param txn the transaction growing the heap
+   * @return false if the transaction had to be aborted
+   */
+  auto Grow(Transaction *txn) -> bool;
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** The page directory, see GetPageIds() */
+  std::vector<page_id_t> page_ids_;
+  /** The directory page the next page id is appended to, guarded by page_ids_latch_ */
+  page_id_t last_directory_page_id_{INVALID_PAGE_ID};
+  std::mutex page_ids_latch_;
+  /** The free space of every page, which InsertTuple() uses to pick a page */
+  FreeSpaceMap free_space_map_;
 };
 
 }  // namespace bustub
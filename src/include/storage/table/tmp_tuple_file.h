@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.h
+//
+// Identification: src/include/storage/table/tmp_tuple_file.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleFile is an append-only sequence of tuples that operators spill to disk when their state does not fit in
+ * memory. Tuples are packed into a private TmpTuplePage buffer and the buffer is copied into a fresh buffer pool page
+ * whenever it fills up, so appending never keeps a frame pinned. Pages are read back one at a time and are deleted
+ * when the file is destroyed.
+ */
+class TmpTupleFile {
+ public:
+  /**
+   * Creates a new, empty TmpTupleFile.
+   * @param bpm the buffer pool manager that holds the spilled pages
+   */
+  explicit TmpTupleFile(BufferPoolManager *bpm);
+
+  ~TmpTupleFile();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleFile);
+
+  /**
+   * Appends a tuple to the file.
+   * @param tuple the tuple to append, it must fit into an empty TmpTuplePage
+   */
+  void Append(const Tuple &tuple);
+
+  /** Writes the partially filled last page out, must be called before the file is read. */
+  void Flush();
+
+  /** @return the number of tuples appended to the file */
+  auto Size() const -> size_t { return num_tuples_; }
+
+  /** @return the number of pages written out */
+  auto NumPages() const -> size_t { return page_ids_.size(); }
+
+  /**
+   * Reads every tuple of a page, in the order they were appended.
+   * @param page_idx the page to read, in [0, NumPages())
+   * @param[out] tuples the tuples of the page, replacing its previous contents
+   */
+  void ReadPage(size_t page_idx, std::vector<Tuple> *tuples);
+
+ private:
+  BufferPoolManager *bpm_;
+  /** The page tuples are currently appended to, it is not part of the buffer pool */
+  std::unique_ptr<TmpTuplePage> buffer_;
+  /** Whether buffer_ holds tuples that are not written out yet */
+  bool buffer_dirty_{false};
+  /** The pages written out so far */
+  std::vector<page_id_t> page_ids_;
+  size_t num_tuples_{0};
+};
+
+}  // namespace bustub
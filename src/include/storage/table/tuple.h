@@ -26,6 +26,11 @@ namespace bustub {
  * ---------------------------------------------------------------------
  * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
  * ---------------------------------------------------------------------
+ *
+ * A tuple either owns its data (IsAllocated()) or is a view of bytes owned by someone else, e.g. a pinned and
+ * latched TablePage or an operator's buffer. Copies of an owning tuple are deep, copies of a view are views of the
+ * same bytes, and moves never copy data. A view is only valid while its owner keeps the bytes alive and unchanged;
+ * anything that keeps a tuple beyond that has to Materialize() it first.
  */
 class Tuple {
   friend class TablePage;
@@ -48,6 +53,24 @@ class Tuple {
   // assign operator, deep copy
   auto operator=(const Tuple &other) -> Tuple &;
 
+  // move constructor, takes over the data of other
+  Tuple(Tuple &&other) noexcept;
+
+  // move assign operator, takes over the data of other
+  auto operator=(Tuple &&other) noexcept -> Tuple &;
+
+  /**
+   * Creates a tuple that references data without copying or owning it.
+   * @param data the serialized tuple, which must outlive the view and every copy of it
+   * @param size the length of the serialized tuple
+   * @param rid the RID of the tuple, if it lives in a table
+   * @return the view
+   */
+  static auto View(const char *data, uint32_t size, RID rid = RID()) -> Tuple;
+
+  // copy the data of a view into a buffer owned by this tuple, no-op for owning tuples
+  void Materialize();
+
   ~Tuple() {
     if (allocated_) {
       delete[] data_;
@@ -64,6 +87,9 @@ class Tuple {
   // return RID of current tuple
   inline auto GetRid() const -> RID { return rid_; }
 
+  // set RID of current tuple
+  inline void SetRid(RID rid) { rid_ = rid; }
+
   // Get the address of this tuple in the table's backing store
   inline auto GetData() const -> char * { return data_; }
 
@@ -75,7 +101,8 @@ class Tuple {
   auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value;
 
   // Generates a key tuple given schemas and attributes
-  auto KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) -> Tuple;
+  auto KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) const
+      -> Tuple;
 
   // Is the column value null ?
   inline auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -30,6 +32,21 @@ void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *t
   container_.Insert(index_key, rid, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries,
+                                         Transaction *transaction) {
+  std::vector<std::pair<KeyType, RID>> index_entries(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    index_entries[i].first.SetFromKey(entries[i].first);
+    index_entries[i].second = entries[i].second;
+  }
+  std::stable_sort(index_entries.begin(), index_entries.end(),
+                   [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; });
+  for (const auto &[index_key, rid] : index_entries) {
+    container_.Insert(index_key, rid, transaction);
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
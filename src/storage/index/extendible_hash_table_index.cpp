@@ -6,15 +6,15 @@ namespace bustub {
 /*
  * Constructor
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata,
                                                 BufferPoolManager *buffer_pool_manager,
-                                                const HashFunction<KeyType> &hash_fn)
+                                                const HashFn &hash_fn)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
       container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
@@ -23,7 +23,7 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   container_.Insert(transaction, index_key, rid);
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
@@ -32,7 +32,7 @@ void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *
   container_.Remove(transaction, index_key, rid);
 }
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename HashFn>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
@@ -46,4 +46,9 @@ template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<1
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>,
+                                        FastIntegerHashFunction<GenericKey<4>>>;
+template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>,
+                                        FastIntegerHashFunction<GenericKey<8>>>;
+
 }  // namespace bustub
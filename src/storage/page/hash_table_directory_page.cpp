@@ -27,7 +27,7 @@ void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
 uint32_t HashTableDirectoryPage::GetGlobalDepth() { return global_depth_; }
 
-uint32_t HashTableDirectoryPage::GetGlobalDepthMask() { return Pow(2, global_depth_) - 1; }
+uint64_t HashTableDirectoryPage::GetGlobalDepthMask() { return (uint64_t{1} << global_depth_) - 1; }
 
 void HashTableDirectoryPage::IncrGlobalDepth() { global_depth_++; }
 
@@ -56,8 +56,8 @@ void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_de
   local_depths_[bucket_idx] = local_depth;
 }
 
-uint32_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) {
-  return Pow(2, GetLocalDepth(bucket_idx)) - 1;
+uint64_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) {
+  return (uint64_t{1} << GetLocalDepth(bucket_idx)) - 1;
 }
 
 void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]++; }
@@ -72,7 +72,7 @@ uint32_t HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) {
 uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) {
   auto high_bits = GetLocalHighBit(bucket_idx);
   uint32_t split_image_index = high_bits | (bucket_idx & (Pow(2, GetLocalDepth(bucket_idx) - 1) - 1));
-  return split_image_index & GetLocalDepthMask(bucket_idx);
+  return static_cast<uint32_t>(split_image_index & GetLocalDepthMask(bucket_idx));
 }
 
 /**
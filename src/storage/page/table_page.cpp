@@ -12,7 +12,11 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <utility>
+#include <vector>
 
 namespace bustub {
 
@@ -38,24 +42,17 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
 auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) -> bool {
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
-  // If there is not enough space, then return false.
-  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
-    return false;
-  }
-
-  // Try to find a free slot to reuse.
-  uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
-      // Then we break out of the loop at index i.
-      break;
+  // Try to find a free slot to reuse, so the tuple needs no new slot.
+  uint32_t i = FindFreeSlot();
+  uint32_t needed = tuple.size_ + (i == GetTupleCount() ? SIZE_TUPLE : 0);
+
+  // If there is not enough free space, compact the page if the holes left by deleted tuples make up for it. Should
+  // compaction drop the free slot, the dropped slots return at least SIZE_TUPLE bytes, so the tuple still fits.
+  if (GetFreeSpaceRemaining() < needed) {
+    if (GetFreeSpaceRemaining() + GetFragmentedSpace() < needed) {
+      return false;
     }
-  }
-
-  // If there was no free slot left, and we cannot claim it from the free space, then we give up.
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
-    return false;
+    Compact();
   }
 
   // Otherwise we claim available free space..
@@ -147,9 +144,13 @@ auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
     }
     return false;
   }
-  // If there is not enuogh space to update, we need to update via delete followed by an insert (not enough space).
+  // If there is not enough space, compact the page if the holes left by deleted tuples make up for it. Otherwise we
+  // need to update via delete followed by an insert (not enough space).
   if (GetFreeSpaceRemaining() + tuple_size < new_tuple.size_) {
-    return false;
+    if (GetFreeSpaceRemaining() + GetFragmentedSpace() + tuple_size < new_tuple.size_) {
+      return false;
+    }
+    Compact();
   }
 
   // Copy out the old value.
@@ -227,22 +228,15 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
     txn->SetPrevLSN(lsn);
   }
 
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
-
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
+  BUSTUB_ASSERT(tuple_offset >= GetFreeSpacePointer(), "Free space appears before tuples.");
+  // Unless the tuple borders the free space, its bytes stay behind as a hole. Compact() reclaims holes once an insert
+  // or update needs the space, instead of every delete shifting all tuples in front of the deleted one.
+  if (tuple_offset == GetFreeSpacePointer()) {
+    SetFreeSpacePointer(tuple_offset + tuple_size);
+  }
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
-
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
-    }
-  }
+  TrimFreeSlots();
 }
 
 void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
@@ -267,6 +261,16 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
 }
 
 auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool {
+  Tuple view;
+  if (!GetTupleView(rid, &view, txn, lock_manager)) {
+    return false;
+  }
+  view.Materialize();
+  *tuple = std::move(view);
+  return true;
+}
+
+auto TablePage::GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, abort the transaction.
@@ -293,19 +297,72 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
     }
   }
 
-  // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  tuple->size_ = tuple_size;
-  if (tuple->allocated_) {
-    delete[] tuple->data_;
-  }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
-  tuple->rid_ = rid;
-  tuple->allocated_ = true;
+  // At this point, we have at least a shared lock on the RID. Point the result at the tuple data.
+  *tuple = Tuple::View(GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size, rid);
   return true;
 }
 
+auto TablePage::Compact() -> uint32_t {
+  uint32_t free_space = GetFreeSpaceRemaining();
+  TrimFreeSlots();
+  if (GetFragmentedSpace() > 0) {
+    // Move the tuples to the end of the page, highest offset first. Every tuple moves towards the end, so it never
+    // overwrites a tuple that has not been moved yet.
+    std::vector<std::pair<uint32_t, uint32_t>> tuples;  // (offset, slot)
+    for (uint32_t i = 0; i < GetTupleCount(); i++) {
+      if (GetTupleSize(i) != 0) {
+        tuples.emplace_back(GetTupleOffsetAtSlot(i), i);
+      }
+    }
+    std::sort(tuples.begin(), tuples.end(), std::greater<>());
+    uint32_t end = PAGE_SIZE;
+    for (const auto &[offset, slot] : tuples) {
+      uint32_t size = UnsetDeletedFlag(GetTupleSize(slot));
+      end -= size;
+      memmove(GetData() + end, GetData() + offset, size);
+      SetTupleOffsetAtSlot(slot, end);
+    }
+    SetFreeSpacePointer(end);
+  }
+  return GetFreeSpaceRemaining() - free_space;
+}
+
+auto TablePage::GetMaxInsertSize() -> uint32_t {
+  uint32_t free_space = GetFreeSpaceRemaining() + GetFragmentedSpace();
+  if (FindFreeSlot() < GetTupleCount()) {
+    return free_space;
+  }
+  return free_space > SIZE_TUPLE ? free_space - SIZE_TUPLE : 0;
+}
+
+auto TablePage::GetFragmentedSpace() -> uint32_t {
+  // Everything between the free space pointer and the end of the page that no tuple, deleted or not, occupies.
+  uint32_t used = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    used += UnsetDeletedFlag(GetTupleSize(i));
+  }
+  return PAGE_SIZE - GetFreeSpacePointer() - used;
+}
+
+auto TablePage::FindFreeSlot() -> uint32_t {
+  uint32_t i;
+  for (i = 0; i < GetTupleCount(); i++) {
+    // If the slot is empty, i.e. its tuple has size 0, it can be reused.
+    if (GetTupleSize(i) == 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+void TablePage::TrimFreeSlots() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+}
+
 auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
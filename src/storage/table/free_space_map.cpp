@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void FreeSpaceMap::AddPage(page_id_t page_id, uint32_t free_bytes) {
+  std::scoped_lock lock{latch_};
+  if (page_ids_.size() == capacity_) {
+    // Double the leaves and rebuild the inner nodes
+    auto new_capacity = std::max<size_t>(capacity_ * 2, 1);
+    std::vector<uint8_t> tree(2 * new_capacity, 0);
+    std::copy(tree_.begin() + capacity_, tree_.end(), tree.begin() + new_capacity);
+    for (size_t node = new_capacity - 1; node > 0; node--) {
+      tree[node] = std::max(tree[2 * node], tree[2 * node + 1]);
+    }
+    tree_ = std::move(tree);
+    capacity_ = new_capacity;
+  }
+  page_index_[page_id] = page_ids_.size();
+  page_ids_.push_back(page_id);
+  SetLeaf(page_ids_.size() - 1, static_cast<uint8_t>(std::min<uint32_t>(free_bytes / CATEGORY_BYTES, UINT8_MAX)));
+}
+
+void FreeSpaceMap::Update(page_id_t page_id, uint32_t free_bytes) {
+  std::scoped_lock lock{latch_};
+  auto iter = page_index_.find(page_id);
+  if (iter != page_index_.end()) {
+    SetLeaf(iter->second, static_cast<uint8_t>(std::min<uint32_t>(free_bytes / CATEGORY_BYTES, UINT8_MAX)));
+  }
+}
+
+auto FreeSpaceMap::FindPage(uint32_t free_bytes, size_t start) -> page_id_t {
+  // Round up, so that every page of the category has at least free_bytes
+  auto needed = (free_bytes + CATEGORY_BYTES - 1) / CATEGORY_BYTES;
+  if (needed > UINT8_MAX) {
+    return INVALID_PAGE_ID;
+  }
+  auto category = static_cast<uint8_t>(needed);
+  std::scoped_lock lock{latch_};
+  if (page_ids_.empty() || tree_[1] < category) {
+    return INVALID_PAGE_ID;
+  }
+  start %= page_ids_.size();
+  auto leaf = FindFirst(1, 0, capacity_, start, category);
+  if (leaf == NO_PAGE) {
+    leaf = FindFirst(1, 0, capacity_, 0, category);
+  }
+  return page_ids_[leaf];
+}
+
+auto FreeSpaceMap::GetNumPages() -> size_t {
+  std::scoped_lock lock{latch_};
+  return page_ids_.size();
+}
+
+auto FreeSpaceMap::FindFirst(size_t node, size_t node_begin, size_t node_end, size_t start, uint8_t category) const
+    -> size_t {
+  if (node_end <= start || tree_[node] < category) {
+    return NO_PAGE;
+  }
+  if (node >= capacity_) {
+    return node_begin;
+  }
+  auto mid = (node_begin + node_end) / 2;
+  auto leaf = FindFirst(2 * node, node_begin, mid, start, category);
+  return leaf != NO_PAGE ? leaf : FindFirst(2 * node + 1, mid, node_end, start, category);
+}
+
+void FreeSpaceMap::SetLeaf(size_t leaf, uint8_t category) {
+  auto node = capacity_ + leaf;
+  tree_[node] = category;
+  for (node /= 2; node > 0; node /= 2) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
+
+}  // namespace bustub
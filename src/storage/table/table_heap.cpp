@@ -10,9 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <thread>  // NOLINT
+#include <utility>
 
 #include "common/logger.h"
+#include "storage/page/table_directory_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -22,7 +27,31 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch a page of the table heap.");
+  first_page->RLatch();
+  auto directory_page_id = first_page->GetDirectoryPageId();
+  first_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  if (LoadDirectory(directory_page_id)) {
+    return;
+  }
+
+  // The table has no usable directory: rebuild it from the page chain.
+  for (auto page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page_ids_.push_back(page_id);
+    page->RLatch();
+    auto next_page_id = page->GetNextPageId();
+    free_space_map_.AddPage(page_id, page->GetMaxInsertSize());
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  WriteDirectory();
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
@@ -32,8 +61,180 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  free_space_map_.AddPage(first_page_id_, first_page->GetMaxInsertSize());
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  page_ids_.push_back(first_page_id_);
+  WriteDirectory();
+}
+
+auto TableHeap::LoadDirectory(page_id_t directory_page_id) -> bool {
+  while (directory_page_id != INVALID_PAGE_ID) {
+    auto directory_page = static_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id));
+    if (directory_page == nullptr) {
+      break;
+    }
+    directory_page->RLatch();
+    auto valid = directory_page->GetDirectoryPageId() == directory_page_id &&
+                 directory_page->GetPageCount() <= TableDirectoryPage::CAPACITY;
+    for (uint32_t i = 0; valid && i < directory_page->GetPageCount(); i++) {
+      page_ids_.push_back(directory_page->GetTablePageId(i));
+    }
+    auto next_page_id = directory_page->GetNextPageId();
+    directory_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    if (!valid) {
+      break;
+    }
+    last_directory_page_id_ = directory_page_id;
+    directory_page_id = next_page_id;
+  }
+
+  // The directory has to cover the whole chain: it starts at the first page and ends at the last one. Pages of the
+  // last extent are read for their free space; older pages count as full until an update or delete frees space.
+  auto valid = directory_page_id == INVALID_PAGE_ID && !page_ids_.empty() && page_ids_.front() == first_page_id_;
+  auto last_extent = page_ids_.size() - std::min(page_ids_.size(), EXTENT_SIZE);
+  std::vector<uint32_t> free_space(page_ids_.size(), 0);
+  for (size_t page_idx = page_ids_.size(); valid && page_idx > last_extent; page_idx--) {
+    auto page_id = page_ids_[page_idx - 1];
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      valid = false;
+      break;
+    }
+    page->RLatch();
+    valid = page->GetTablePageId() == page_id &&
+            (page_idx < page_ids_.size() || page->GetNextPageId() == INVALID_PAGE_ID);
+    free_space[page_idx - 1] = page->GetMaxInsertSize();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  if (!valid) {
+    page_ids_.clear();
+    last_directory_page_id_ = INVALID_PAGE_ID;
+    return false;
+  }
+  for (size_t page_idx = 0; page_idx < page_ids_.size(); page_idx++) {
+    free_space_map_.AddPage(page_ids_[page_idx], free_space[page_idx]);
+  }
+  return true;
+}
+
+void TableHeap::WriteDirectory() {
+  page_id_t first_directory_page_id = INVALID_PAGE_ID;
+  {
+    std::scoped_lock lock{page_ids_latch_};
+    last_directory_page_id_ = INVALID_PAGE_ID;
+    for (auto page_id : page_ids_) {
+      AppendToDirectory(page_id);
+      if (first_directory_page_id == INVALID_PAGE_ID) {
+        first_directory_page_id = last_directory_page_id_;
+      }
+    }
+  }
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch a page of the table heap.");
+  first_page->WLatch();
+  first_page->SetDirectoryPageId(first_directory_page_id);
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+}
+
+void TableHeap::AppendToDirectory(page_id_t page_id) {
+  if (last_directory_page_id_ != INVALID_PAGE_ID) {
+    auto directory_page = static_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(last_directory_page_id_));
+    BUSTUB_ASSERT(directory_page != nullptr, "Couldn't fetch a directory page of the table heap.");
+    directory_page->WLatch();
+    bool appended = directory_page->Append(page_id);
+    directory_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_directory_page_id_, appended);
+    if (appended) {
+      return;
+    }
+  }
+
+  // Start a new directory page
+  page_id_t new_page_id;
+  auto new_page = static_cast<TableDirectoryPage *>(buffer_pool_manager_->NewPage(&new_page_id));
+  BUSTUB_ASSERT(new_page != nullptr, "Couldn't create a directory page for the table heap.");
+  new_page->WLatch();
+  new_page->Init(new_page_id);
+  new_page->Append(page_id);
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  if (last_directory_page_id_ != INVALID_PAGE_ID) {
+    auto directory_page = static_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(last_directory_page_id_));
+    directory_page->WLatch();
+    directory_page->SetNextPageId(new_page_id);
+    directory_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_directory_page_id_, true);
+  }
+  last_directory_page_id_ = new_page_id;
+}
+
+auto TableHeap::AllocateExtent(TablePage *last_page, Transaction *txn) -> bool {
+  std::vector<page_id_t> new_page_ids;
+  uint32_t free_space = 0;
+  TablePage *prev_page = last_page;
+  for (size_t i = 0; i < EXTENT_SIZE; i++) {
+    page_id_t new_page_id;
+    auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id));
+    if (new_page == nullptr) {
+      // The buffer pool is exhausted: make do with a shorter extent
+      break;
+    }
+    // The new pages are unreachable until they are linked and published below, so they need no latch.
+    new_page->Init(new_page_id, PAGE_SIZE, prev_page->GetTablePageId(), log_manager_, txn);
+    prev_page->SetNextPageId(new_page_id);
+    if (prev_page != last_page) {
+      buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), true);
+    }
+    free_space = new_page->GetMaxInsertSize();
+    new_page_ids.push_back(new_page_id);
+    prev_page = new_page;
+  }
+  if (prev_page != last_page) {
+    buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), true);
+  }
+  if (new_page_ids.empty()) {
+    return false;
+  }
+
+  std::scoped_lock lock{page_ids_latch_};
+  for (auto page_id : new_page_ids) {
+    page_ids_.push_back(page_id);
+    AppendToDirectory(page_id);
+    free_space_map_.AddPage(page_id, free_space);
+  }
+  return true;
+}
+
+auto TableHeap::Grow(Transaction *txn) -> bool {
+  page_id_t last_page_id;
+  {
+    std::scoped_lock lock{page_ids_latch_};
+    last_page_id = page_ids_.back();
+  }
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  if (last_page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  last_page->WLatch();
+  if (last_page->GetNextPageId() != INVALID_PAGE_ID) {
+    // Someone else grew the heap, and its pages are in the free space map by now
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, false);
+    return true;
+  }
+  bool allocated = AllocateExtent(last_page, txn);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id, allocated);
+  if (!allocated) {
+    // If we could not create a new page, then life sucks and we abort the transaction.
+    txn->SetState(TransactionState::ABORTED);
+  }
+  return allocated;
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
@@ -42,51 +243,100 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  // Every thread starts looking at its own position, so concurrent inserters spread out over the pages with space.
+  auto start = std::hash<std::thread::id>()(std::this_thread::get_id());
+  while (true) {
+    auto page_id = free_space_map_.FindPage(tuple.size_, start);
+    if (page_id == INVALID_PAGE_ID) {
+      // No page has enough space: add an extent of empty pages and look again.
+      if (!Grow(txn)) {
+        return false;
+      }
+      continue;
+    }
+
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    bool inserted = page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    // On failure the map was stale; correcting it keeps the next search from picking the page again.
+    free_space_map_.Update(page_id, page->GetMaxInsertSize());
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      break;
+    }
+  }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
+
+auto TableHeap::InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) -> bool {
+  rids->clear();
+  for (const auto &tuple : tuples) {
+    if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  if (tuples.empty()) {
+    return true;
+  }
+
+  page_id_t last_page_id;
+  {
+    std::scoped_lock lock{page_ids_latch_};
+    last_page_id = page_ids_.back();
+  }
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
   cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
+  rids->reserve(tuples.size());
+  bool cur_page_dirty = false;
+  // INVARIANT: cur_page is WLatched and pinned at the top of the loop.
+  for (const auto &tuple : tuples) {
+    RID rid;
+    while (!cur_page->InsertTuple(tuple, &rid, txn, lock_manager_, log_manager_)) {
+      // The page is full: move on to the next page, which a concurrent insert may have appended already.
+      if (cur_page->GetNextPageId() == INVALID_PAGE_ID) {
+        if (!AllocateExtent(cur_page, txn)) {
+          cur_page->WUnlatch();
+          buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), cur_page_dirty);
+          txn->SetState(TransactionState::ABORTED);
+          return false;
+        }
+        cur_page_dirty = true;
+      }
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(cur_page->GetNextPageId()));
+      if (next_page == nullptr) {
+        free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetMaxInsertSize());
         cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), cur_page_dirty);
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      next_page->WLatch();
+      free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetMaxInsertSize());
       cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), cur_page_dirty);
+      cur_page = next_page;
+      cur_page_dirty = false;
     }
+    cur_page_dirty = true;
+    rids->push_back(rid);
+    txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
+  free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetMaxInsertSize());
   cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), cur_page_dirty);
   return true;
 }
 
@@ -121,6 +371,7 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   Tuple old_tuple;
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  free_space_map_.Update(rid.GetPageId(), page->GetMaxInsertSize());
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
@@ -137,6 +388,7 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Delete the tuple from the page.
   page->WLatch();
   page->ApplyDelete(rid, txn, log_manager_);
+  free_space_map_.Update(rid.GetPageId(), page->GetMaxInsertSize());
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
@@ -189,6 +441,71 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   return TableIterator(this, rid, txn);
 }
 
+auto TableHeap::GetPageIds() -> std::vector<page_id_t> {
+  std::scoped_lock lock{page_ids_latch_};
+  return page_ids_;
+}
+
+auto TableHeap::GetNumPages() -> size_t {
+  std::scoped_lock lock{page_ids_latch_};
+  return page_ids_.size();
+}
+
+auto TableHeap::GetPageId(size_t page_idx) -> page_id_t {
+  std::scoped_lock lock{page_ids_latch_};
+  return page_idx < page_ids_.size() ? page_ids_[page_idx] : INVALID_PAGE_ID;
+}
+
+auto TableHeap::ScanPage(page_id_t page_id, Transaction *txn, const std::function<void(const Tuple &)> &visitor)
+    -> bool {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    return false;
+  }
+  page->RLatch();
+  RID rid;
+  Tuple tuple;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    if (page->GetTupleView(rid, &tuple, txn, lock_manager_)) {
+      visitor(tuple);
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
+auto TableHeap::Vacuum(TaskGroup *group) -> size_t {
+  auto page_ids = GetPageIds();
+  std::atomic<size_t> reclaimed{0};
+  auto num_tasks = static_cast<uint32_t>((page_ids.size() + EXTENT_SIZE - 1) / EXTENT_SIZE);
+  auto vacuum_extent = [&](uint32_t task_idx) {
+    auto end = std::min(page_ids.size(), (task_idx + 1) * EXTENT_SIZE);
+    for (auto page_idx = task_idx * EXTENT_SIZE; page_idx < end; page_idx++) {
+      auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids[page_idx]));
+      if (page == nullptr) {
+        continue;
+      }
+      page->WLatch();
+      auto page_reclaimed = page->Compact();
+      if (page_reclaimed > 0) {
+        free_space_map_.Update(page_ids[page_idx], page->GetMaxInsertSize());
+      }
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page_ids[page_idx], page_reclaimed > 0);
+      reclaimed += page_reclaimed;
+    }
+  };
+  if (group != nullptr) {
+    group->RunParallel(num_tasks, vacuum_extent);
+  } else {
+    for (uint32_t task_idx = 0; task_idx < num_tasks; task_idx++) {
+      vacuum_extent(task_idx);
+    }
+  }
+  return reclaimed;
+}
+
 auto TableHeap::End() -> TableIterator { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
 }  // namespace bustub
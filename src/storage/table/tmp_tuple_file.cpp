@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.cpp
+//
+// Identification: src/storage/table/tmp_tuple_file.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_file.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TmpTupleFile::TmpTupleFile(BufferPoolManager *bpm) : bpm_(bpm), buffer_(std::make_unique<TmpTuplePage>()) {
+  buffer_->Init(INVALID_PAGE_ID, PAGE_SIZE);
+}
+
+TmpTupleFile::~TmpTupleFile() {
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleFile::Append(const Tuple &tuple) {
+  TmpTuple out(INVALID_PAGE_ID, 0);
+  if (!buffer_->Insert(tuple, &out)) {
+    Flush();
+    if (!buffer_->Insert(tuple, &out)) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "tuple does not fit into a temporary page");
+    }
+  }
+  buffer_dirty_ = true;
+  num_tuples_++;
+}
+
+void TmpTupleFile::Flush() {
+  if (!buffer_dirty_) {
+    return;
+  }
+  page_id_t page_id;
+  Page *page = bpm_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill a temporary page");
+  }
+  buffer_->SetTablePageId(page_id);
+  memcpy(page->GetData(), buffer_->GetData(), PAGE_SIZE);
+  bpm_->UnpinPage(page_id, true);
+  page_ids_.push_back(page_id);
+  buffer_->Init(INVALID_PAGE_ID, PAGE_SIZE);
+  buffer_dirty_ = false;
+}
+
+void TmpTupleFile::ReadPage(size_t page_idx, std::vector<Tuple> *tuples) {
+  tuples->clear();
+  auto page_id = page_ids_[page_idx];
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to read a temporary page");
+  }
+  for (size_t offset = page->GetFreeSpacePointer(); offset < PAGE_SIZE; offset = page->GetNextTupleOffset(offset)) {
+    tuples->emplace_back();
+    page->Get(offset, &tuples->back());
+  }
+  bpm_->UnpinPage(page_id, false);
+  // tuples are stored back to front
+  std::reverse(tuples->begin(), tuples->end());
+}
+
+}  // namespace bustub
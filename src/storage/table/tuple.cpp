@@ -54,9 +54,6 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
 }
 
 Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
-  if (allocated_) {
-    delete[] data_;
-  }
   if (allocated_) {
     // Deep copy.
     data_ = new char[size_];
@@ -68,6 +65,9 @@ Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_
 }
 
 auto Tuple::operator=(const Tuple &other) -> Tuple & {
+  if (this == &other) {
+    return *this;
+  }
   if (allocated_) {
     delete[] data_;
   }
@@ -87,6 +87,48 @@ auto Tuple::operator=(const Tuple &other) -> Tuple & {
   return *this;
 }
 
+Tuple::Tuple(Tuple &&other) noexcept
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), data_(other.data_) {
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+}
+
+auto Tuple::operator=(Tuple &&other) noexcept -> Tuple & {
+  if (this == &other) {
+    return *this;
+  }
+  if (allocated_) {
+    delete[] data_;
+  }
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  data_ = other.data_;
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+  return *this;
+}
+
+auto Tuple::View(const char *data, uint32_t size, RID rid) -> Tuple {
+  Tuple tuple(rid);
+  // Views are never written through, the pointer is only non-const because owning tuples share the member.
+  tuple.data_ = const_cast<char *>(data);
+  tuple.size_ = size;
+  return tuple;
+}
+
+void Tuple::Materialize() {
+  if (allocated_ || data_ == nullptr) {
+    return;
+  }
+  auto *data = new char[size_];
+  memcpy(data, data_, size_);
+  data_ = data;
+  allocated_ = true;
+}
+
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
   assert(data_);
@@ -96,7 +138,7 @@ auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> V
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
-auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
+auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) const
     -> Tuple {
   std::vector<Value> values;
   values.reserve(key_attrs.size());
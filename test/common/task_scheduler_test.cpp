@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// task_scheduler_test.cpp
+//
+// Identification: test/common/task_scheduler_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/task_scheduler.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TaskSchedulerTest, RunParallelTest) {
+  TaskScheduler scheduler(4);
+  auto group = scheduler.CreateTaskGroup();
+  std::vector<std::atomic<int>> runs(64);
+  group->RunParallel(64, [&](uint32_t task_idx) {
+    // Nested calls are run by the waiting task itself if the workers are busy
+    group->RunParallel(4, [&](uint32_t /* nested_idx */) { runs[task_idx]++; });
+  });
+  for (auto &run : runs) {
+    EXPECT_EQ(run, 4);
+  }
+
+  // Without workers the calling thread runs every task
+  TaskScheduler no_workers(0);
+  auto lone_group = no_workers.CreateTaskGroup();
+  std::atomic<int> count{0};
+  lone_group->RunParallel(10, [&](uint32_t /* task_idx */) { count++; });
+  EXPECT_EQ(count, 10);
+}
+
+// NOLINTNEXTLINE
+TEST(TaskSchedulerTest, ConcurrencyCapTest) {
+  TaskScheduler scheduler(4);
+  auto group = scheduler.CreateTaskGroup(0, 1);
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  group->RunParallel(32, [&](uint32_t /* task_idx */) {
+    int now = ++running;
+    for (int seen = max_running; now > seen && !max_running.compare_exchange_weak(seen, now);) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    running--;
+  });
+  // One worker plus the calling thread
+  EXPECT_LE(max_running, 2);
+}
+
+// NOLINTNEXTLINE
+TEST(TaskSchedulerTest, CancelAndExceptionTest) {
+  TaskScheduler scheduler(2);
+  auto group = scheduler.CreateTaskGroup();
+  std::atomic<int> count{0};
+  group->RunParallel(100, [&](uint32_t /* task_idx */) {
+    count++;
+    group->Cancel();
+  });
+  EXPECT_TRUE(group->IsCancelled());
+  EXPECT_LT(count, 100);
+
+  auto failing_group = scheduler.CreateTaskGroup();
+  EXPECT_THROW(failing_group->RunParallel(8,
+                                          [](uint32_t task_idx) {
+                                            if (task_idx == 5) {
+                                              throw std::runtime_error("task failed");
+                                            }
+                                          }),
+               std::runtime_error);
+}
+
+}  // namespace bustub
@@ -10,12 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
 #include "container/hash/extendible_hash_table.h"
+#include "container/hash/open_addressing_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
 
@@ -117,4 +119,78 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+/**
+ * Inserts num_keys distinct integer keys and checks that they can all be read back, and that the directory index
+ * bits of their hashes are spread evenly.
+ */
+template <typename HashFn>
+void InsertAndVerify(int num_keys) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator, HashFn> ht("blah", bpm, IntComparator(), HashFn());
+
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i << std::endl;
+  }
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // keys that only differ above the directory index bits still have to spread over all directory slots
+  HashFn hash_fn;
+  std::vector<int> slot_counts(DIRECTORY_ARRAY_SIZE, 0);
+  for (int i = 0; i < num_keys; i++) {
+    slot_counts[hash_fn.GetHash(i * DIRECTORY_ARRAY_SIZE) & (DIRECTORY_ARRAY_SIZE - 1)]++;
+  }
+  EXPECT_LT(*std::max_element(slot_counts.begin(), slot_counts.end()), 2 * num_keys / DIRECTORY_ARRAY_SIZE);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, IntegerHashFunctionTest) {
+  const int num_keys = 20000;
+  InsertAndVerify<HashFunction<int>>(num_keys);
+  InsertAndVerify<MultiplyShiftHashFunction<int>>(num_keys);
+  InsertAndVerify<FastIntegerHashFunction<int>>(num_keys);
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, OpenAddressingTest) {
+  OpenAddressingHashTable<int, int> ht;
+  const int num_keys = 5000;
+  // few distinct hashes force long probe sequences and tag collisions
+  auto hash_of = [](int key) -> hash_t { return static_cast<hash_t>(key % 7); };
+
+  auto first = ht.FindOrInsert(hash_of(0), 0, [] { return 0; });
+  EXPECT_TRUE(first.second);
+  for (int i = 1; i < num_keys; i++) {
+    auto result = ht.FindOrInsert(hash_of(i), i, [i] { return i * 2; });
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(i * 2, *result.first);
+  }
+  // values stay where they are while the table grows
+  EXPECT_EQ(0, *first.first);
+  EXPECT_EQ(static_cast<size_t>(num_keys), ht.Size());
+
+  for (int i = 0; i < num_keys; i++) {
+    auto result = ht.FindOrInsert(hash_of(i), i, [] { return -1; });
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(i * 2, *ht.Find(hash_of(i), i));
+    EXPECT_EQ(i, ht.EntryAt(i).key_);
+  }
+  EXPECT_EQ(nullptr, ht.Find(hash_of(num_keys), num_keys));
+
+  ht.Clear();
+  EXPECT_EQ(0, ht.Size());
+  EXPECT_EQ(nullptr, ht.Find(hash_of(1), 1));
+}
+
 }  // namespace bustub
@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -23,23 +26,38 @@
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
+#include "execution/executor_factory.h"
+#include "execution/pipeline_execution_engine.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/hash_join_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/topn_executor.h"
+#include "execution/executors/streaming_aggregation_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/expressions/constant_value_expression.h"
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/insert_plan.h"
 #include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
 #include "execution/plans/update_plan.h"
 #include "executor_test_util.h"  // NOLINT
 #include "gtest/gtest.h"
 #include "storage/table/tuple.h"
 #include "test_util.h"  // NOLINT
+#include "type/limits.h"
 #include "type/value_factory.h"
 
 /**
@@ -112,6 +130,146 @@ TEST_F(ExecutorTest, SimpleSeqScanTest) {
   }
 }
 
+// SELECT colA, colB FROM test_1 WHERE colA < 500, batch at a time
+TEST_F(ExecutorTest, SeqScanBatchTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  executor->Init();
+  TupleBatch batch(out_schema, 64);
+  size_t num_rows = 0;
+  while (executor->NextBatch(&batch)) {
+    ASSERT_LE(batch.NumRows(), 64);
+    const auto &col_a_values = batch.GetColumn(0).GetIntegers();
+    for (uint32_t i = 0; i < batch.NumSelected(); i++) {
+      auto row = batch.SelectedRow(i);
+      ASSERT_LT(col_a_values[row], 500);
+      ASSERT_LT(batch.GetValue(1, row).GetAs<int32_t>(), 10);
+    }
+    num_rows += batch.NumSelected();
+  }
+  ASSERT_EQ(num_rows, 500);
+}
+
+// SELECT * FROM test_1 and SELECT * FROM test_1 LIMIT 100, the result tuples keep the RIDs of the table rows
+TEST_F(ExecutorTest, ResultRidTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  std::vector<std::pair<std::string, const AbstractExpression *>> columns;
+  for (const auto &column : schema.GetColumns()) {
+    columns.emplace_back(column.GetName(), MakeColumnValueExpression(schema, 0, column.GetName()));
+  }
+  auto *out_schema = MakeOutputSchema(columns);
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+  // The scan is vectorized, the limit above it hands on the tuples it pulls through Next()
+  LimitPlanNode limit_plan{out_schema, &scan_plan, 100};
+
+  for (const AbstractPlanNode *plan : std::vector<const AbstractPlanNode *>{&scan_plan, &limit_plan}) {
+    std::vector<Tuple> result_set;
+    ASSERT_TRUE(GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext()));
+    ASSERT_EQ(result_set.size(), plan == &scan_plan ? TEST1_SIZE : 100);
+    for (const auto &tuple : result_set) {
+      Tuple table_tuple;
+      ASSERT_TRUE(table_info->table_->GetTuple(tuple.GetRid(), &table_tuple, GetTxn()));
+      ASSERT_EQ(table_tuple.GetValue(&schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+    }
+  }
+}
+
+// SELECT test_1.colA, test_2.col1 FROM test_1, test_2, streamed to a consumer that stops after the first batch
+TEST_F(ExecutorTest, StreamingResultTest) {
+  auto *table1 = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *schema1 = MakeOutputSchema({{"colA", MakeColumnValueExpression(table1->schema_, 0, "colA")}});
+  SeqScanPlanNode scan1{schema1, nullptr, table1->oid_};
+  auto *table2 = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *schema2 = MakeOutputSchema({{"col1", MakeColumnValueExpression(table2->schema_, 0, "col1")}});
+  SeqScanPlanNode scan2{schema2, nullptr, table2->oid_};
+  auto *out_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(*schema1, 0, "colA")},
+                                       {"col1", MakeColumnValueExpression(*schema2, 1, "col1")}});
+  NestedLoopJoinPlanNode join_plan{out_schema, {&scan1, &scan2}, nullptr};
+
+  size_t num_rows = 0;
+  size_t num_batches = 0;
+  auto on_batch = [&](const TupleBatch &batch) {
+    num_rows += batch.NumSelected();
+    num_batches++;
+    return false;
+  };
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&join_plan, on_batch, GetTxn(), GetExecutorContext()));
+  // The join stops with the consumer instead of producing all of its TEST1_SIZE * TEST2_SIZE rows
+  ASSERT_EQ(num_batches, 1);
+  ASSERT_EQ(num_rows, TupleBatch::DEFAULT_BATCH_SIZE);
+}
+
+// SELECT colA, colB FROM test_1 WHERE colA < 500, scanned by four threads through the exchange
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  GetExecutorContext()->SetParallelism(4);
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  executor->Init();
+  std::vector<int32_t> col_a_values;
+  Tuple tuple;
+  RID rid;
+  while (executor->Next(&tuple, &rid)) {
+    col_a_values.push_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+  }
+  std::sort(col_a_values.begin(), col_a_values.end());
+  ASSERT_EQ(col_a_values.size(), 500);
+  for (int32_t i = 0; i < 500; i++) {
+    ASSERT_EQ(col_a_values[i], i);
+  }
+
+  // A parent consuming batches on the scan threads sees the same rows
+  auto *scan = dynamic_cast<SeqScanExecutor *>(executor.get());
+  ASSERT_NE(scan, nullptr);
+  scan->Init();
+  std::atomic<size_t> num_rows{0};
+  scan->ParallelScan(4, [&](uint32_t /* thread_idx */, const TupleBatch &batch) { num_rows += batch.NumSelected(); });
+  ASSERT_EQ(num_rows, 500);
+}
+
+// Compiled predicates agree with the interpreted expressions on every row of test_1
+TEST_F(ExecutorTest, CompiledPredicateTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *const_bigint = MakeConstantValueExpression(ValueFactory::GetBigIntValue(5));
+  auto *const_decimal = MakeConstantValueExpression(ValueFactory::GetDecimalValue(4.5));
+  std::vector<const AbstractExpression *> predicates{
+      MakeComparisonExpression(col_a, const500, ComparisonType::LessThan),
+      MakeComparisonExpression(const500, col_a, ComparisonType::LessThanOrEqual),
+      MakeComparisonExpression(col_b, const_bigint, ComparisonType::Equal),
+      MakeComparisonExpression(col_b, const_decimal, ComparisonType::GreaterThan),
+      MakeComparisonExpression(col_a, col_b, ComparisonType::NotEqual),
+      MakeConstantValueExpression(ValueFactory::GetBooleanValue(true)),
+  };
+
+  for (const auto *predicate : predicates) {
+    auto compiled = CompiledPredicate::Compile(predicate, &schema);
+    ASSERT_NE(compiled, nullptr);
+    for (auto iter = table_info->table_->Begin(GetTxn()); iter != table_info->table_->End(); ++iter) {
+      ASSERT_EQ(compiled->Evaluate(*iter), predicate->Evaluate(&(*iter), &schema).GetAs<bool>());
+    }
+  }
+}
+
 // SELECT colC FROM test_4 WHERE colC > 10
 TEST_F(ExecutorTest, SeqScanTestOne) {
   // Construct query plan
@@ -1227,6 +1385,201 @@ TEST_F(ExecutorTest, NestedLoopJoinTestTwo) {
   }
 }
 
+// SELECT test_2.col1, test_1.colA FROM test_2 JOIN test_1 ON test_2.col1 > test_1.colA, with small outer batches
+TEST_F(ExecutorTest, BlockNestedLoopJoinTest) {
+  auto *outer_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *outer_schema = MakeOutputSchema({{"col1", MakeColumnValueExpression(outer_info->schema_, 0, "col1")}});
+  SeqScanPlanNode outer_plan{outer_schema, nullptr, outer_info->oid_};
+  auto *inner_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *inner_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(inner_info->schema_, 0, "colA")}});
+  SeqScanPlanNode inner_plan{inner_schema, nullptr, inner_info->oid_};
+
+  auto col1 = MakeColumnValueExpression(*outer_schema, 0, "col1");
+  auto col_a = MakeColumnValueExpression(*inner_schema, 1, "colA");
+  auto *out_final = MakeOutputSchema({{"col1", col1}, {"colA", col_a}});
+  NestedLoopJoinPlanNode join_plan{out_final, {&outer_plan, &inner_plan},
+                                   MakeComparisonExpression(col1, col_a, ComparisonType::GreaterThan)};
+
+  auto run = [&](size_t memory_budget, size_t *num_inner_scans) {
+    GetExecutorContext()->SetMemoryBudget(memory_budget);
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+    executor->Init();
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      auto outer = tuple.GetValue(out_final, 0).GetAs<int16_t>();
+      auto inner = tuple.GetValue(out_final, 1).GetAs<int32_t>();
+      EXPECT_GT(outer, inner);
+      rows.emplace_back(outer, inner);
+    }
+    *num_inner_scans = dynamic_cast<NestedLoopJoinExecutor *>(executor.get())->GetNumInnerScans();
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+
+  // With the default budget the whole outer table is one batch and the inner table is scanned once
+  size_t num_inner_scans;
+  auto one_batch = run(DEFAULT_EXECUTOR_MEMORY_BUDGET, &num_inner_scans);
+  ASSERT_EQ(num_inner_scans, 1);
+  ASSERT_EQ(one_batch.size(), TEST2_SIZE * (TEST2_SIZE - 1) / 2);
+
+  auto small_batches = run(1024, &num_inner_scans);
+  ASSERT_GT(num_inner_scans, 1);
+  ASSERT_LT(num_inner_scans, TEST2_SIZE);
+  ASSERT_EQ(small_batches, one_batch);
+}
+
+// SELECT * FROM (SELECT colA FROM test_1 WHERE colA < 0) JOIN (SELECT COUNT(colA) FROM test_1), an empty outer side
+TEST_F(ExecutorTest, EmptyOuterNestedLoopJoinTest) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *scan_col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *scan_schema = MakeOutputSchema({{"colA", scan_col_a}});
+  auto *negative = MakeComparisonExpression(scan_col_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(0)),
+                                            ComparisonType::LessThan);
+  SeqScanPlanNode outer_plan{scan_schema, negative, table_info->oid_};
+  SeqScanPlanNode inner_scan{scan_schema, nullptr, table_info->oid_};
+  auto *col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *agg_schema = MakeOutputSchema({{"countA", MakeAggregateValueExpression(false, 0)}});
+  AggregationPlanNode inner_plan{agg_schema, &inner_scan, nullptr, {}, {col_a}, {AggregationType::CountAggregate}};
+
+  auto *outer_col = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *inner_col = MakeColumnValueExpression(*agg_schema, 1, "countA");
+  auto *out_schema = MakeOutputSchema({{"colA", outer_col}, {"countA", inner_col}});
+  NestedLoopJoinPlanNode join_plan{out_schema, {&outer_plan, &inner_plan}, nullptr};
+
+  // The inner child is never initialized, so it must not be read either
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  ASSERT_FALSE(executor->Next(&tuple, &rid));
+  ASSERT_FALSE(executor->Next(&tuple, &rid));
+  ASSERT_EQ(dynamic_cast<NestedLoopJoinExecutor *>(executor.get())->GetNumInnerScans(), 0);
+
+  std::vector<Tuple> result_set;
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_TRUE(result_set.empty());
+}
+
+// SELECT test_2.col1, test_1.colA, test_1.colB FROM test_2 JOIN test_1 ON test_2.col1 = test_1.colA, probing an index
+TEST_F(ExecutorTest, NestedIndexJoinTest) {
+  auto *inner_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto key_schema = ParseCreateStatement("colA int");
+  GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", inner_info->schema_, *key_schema, {0}, 8, HashFunctionType{});
+
+  auto *outer_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *outer_schema = MakeOutputSchema({{"col1", MakeColumnValueExpression(outer_info->schema_, 0, "col1")}});
+  SeqScanPlanNode outer_plan{outer_schema, nullptr, outer_info->oid_};
+
+  auto col1 = MakeColumnValueExpression(*outer_schema, 0, "col1");
+  auto col_a = MakeColumnValueExpression(inner_info->schema_, 1, "colA");
+  auto col_b = MakeColumnValueExpression(inner_info->schema_, 1, "colB");
+  auto *out_final = MakeOutputSchema({{"col1", col1}, {"colA", col_a}, {"colB", col_b}});
+  NestedIndexJoinPlanNode join_plan{out_final,
+                                    {&outer_plan},
+                                    MakeComparisonExpression(col1, col_a, ComparisonType::Equal),
+                                    inner_info->oid_,
+                                    "index1",
+                                    outer_schema,
+                                    &inner_info->schema_};
+
+  auto run = [&](size_t memory_budget) {
+    GetExecutorContext()->SetMemoryBudget(memory_budget);
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      auto outer = tuple.GetValue(out_final, 0).GetAs<int16_t>();
+      EXPECT_EQ(outer, tuple.GetValue(out_final, 1).GetAs<int32_t>());
+      rows.emplace_back(outer, tuple.GetValue(out_final, 2).GetAs<int32_t>());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+
+  auto one_batch = run(DEFAULT_EXECUTOR_MEMORY_BUDGET);
+  ASSERT_EQ(one_batch.size(), TEST2_SIZE);
+  for (size_t i = 0; i < one_batch.size(); i++) {
+    ASSERT_EQ(one_batch[i].first, i);
+    ASSERT_LT(one_batch[i].second, 10);
+  }
+  ASSERT_EQ(run(256), one_batch);
+}
+
+// SELECT test_1.colA, test_3.colB FROM test_1 JOIN test_3 ON test_1.colA = test_3.colA, probing an index
+TEST_F(ExecutorTest, NestedIndexJoinRuntimeFilterTest) {
+  auto *inner_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
+  auto key_schema = ParseCreateStatement("colA int");
+  GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index3", "test_3", inner_info->schema_, *key_schema, {0}, 8, HashFunctionType{});
+
+  auto *outer_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *outer_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(outer_info->schema_, 0, "colA")}});
+  SeqScanPlanNode outer_plan{outer_schema, nullptr, outer_info->oid_};
+
+  auto outer_a = MakeColumnValueExpression(*outer_schema, 0, "colA");
+  auto inner_a = MakeColumnValueExpression(inner_info->schema_, 1, "colA");
+  auto inner_b = MakeColumnValueExpression(inner_info->schema_, 1, "colB");
+  auto *out_final = MakeOutputSchema({{"colA", outer_a}, {"colB", inner_b}});
+  NestedIndexJoinPlanNode join_plan{out_final,
+                                    {&outer_plan},
+                                    MakeComparisonExpression(outer_a, inner_a, ComparisonType::Equal),
+                                    inner_info->oid_,
+                                    "index3",
+                                    outer_schema,
+                                    &inner_info->schema_};
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+  executor->Init();
+  std::vector<int32_t> keys;
+  Tuple tuple;
+  RID rid;
+  while (executor->Next(&tuple, &rid)) {
+    auto key = tuple.GetValue(out_final, 0).GetAs<int32_t>();
+    ASSERT_EQ(key, tuple.GetValue(out_final, 1).GetAs<int32_t>());
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  ASSERT_EQ(keys.size(), TEST3_SIZE);
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(keys[i], i);
+  }
+
+  // The outer scan drops most rows without a partner in the small inner table
+  auto filter = dynamic_cast<NestIndexJoinExecutor *>(executor.get())->GetRuntimeFilter();
+  ASSERT_NE(filter, nullptr);
+  ASSERT_EQ(filter->GetRowsChecked(), TEST1_SIZE);
+  ASSERT_GE(filter->GetRowsEliminated(), 850);
+  ASSERT_LE(filter->GetRowsEliminated(), TEST1_SIZE - TEST3_SIZE);
+
+  // Joined the other way round, the small outer table only probes the index and the large inner table is not scanned
+  GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", outer_info->schema_, *key_schema, {0}, 8, HashFunctionType{});
+  auto *small_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(inner_info->schema_, 0, "colA")}});
+  SeqScanPlanNode small_plan{small_schema, nullptr, inner_info->oid_};
+  auto small_a = MakeColumnValueExpression(*small_schema, 0, "colA");
+  auto large_a = MakeColumnValueExpression(outer_info->schema_, 1, "colA");
+  auto *reverse_final = MakeOutputSchema({{"colA", small_a}, {"largeA", large_a}});
+  NestedIndexJoinPlanNode reverse_plan{reverse_final,
+                                       {&small_plan},
+                                       MakeComparisonExpression(small_a, large_a, ComparisonType::Equal),
+                                       outer_info->oid_,
+                                       "index1",
+                                       small_schema,
+                                       &outer_info->schema_};
+  executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &reverse_plan);
+  executor->Init();
+  size_t num_rows = 0;
+  while (executor->Next(&tuple, &rid)) {
+    num_rows++;
+  }
+  ASSERT_EQ(num_rows, TEST3_SIZE);
+  ASSERT_EQ(dynamic_cast<NestIndexJoinExecutor *>(executor.get())->GetRuntimeFilter(), nullptr);
+}
+
 // SELECT test_4.colA, test_4.colB, test_6.colA, test_6.colB FROM test_4 JOIN test_6 ON test_4.colA = test_6.colA;
 TEST_F(ExecutorTest, SimpleHashJoinTest) {
   // Construct sequential scan of table test_4
@@ -1410,6 +1763,177 @@ TEST_F(ExecutorTest, HashJoinTestTwo) {
   }
 }
 
+// SELECT l.colA, l.colB, r.colA, r.colB FROM test_1 l JOIN test_1 r ON l.colA = r.colA, with a tiny memory budget
+TEST_F(ExecutorTest, HashJoinSpillTest) {
+  const Schema *out_schema1;
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema2;
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto col_a = MakeColumnValueExpression(schema, 0, "colA");
+    auto col_b = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+    out_schema2 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+
+  const Schema *out_final;
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto left_a = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto left_b = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto right_a = MakeColumnValueExpression(*out_schema2, 1, "colA");
+    auto right_b = MakeColumnValueExpression(*out_schema2, 1, "colB");
+    out_final = MakeOutputSchema({{"left_colA", left_a}, {"left_colB", left_b}, {"right_colA", right_a},
+                                  {"right_colB", right_b}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, left_a, right_a);
+  }
+
+  // Forces the build side to spill and the spilled partitions to be split again
+  GetExecutorContext()->SetMemoryBudget(1024);
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(join_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+
+  std::unordered_set<int32_t> seen;
+  for (const auto &tuple : result_set) {
+    auto left_a = tuple.GetValue(out_final, 0).GetAs<int32_t>();
+    ASSERT_EQ(left_a, tuple.GetValue(out_final, 2).GetAs<int32_t>());
+    ASSERT_EQ(tuple.GetValue(out_final, 1).GetAs<int32_t>(), tuple.GetValue(out_final, 3).GetAs<int32_t>());
+    seen.insert(left_a);
+  }
+  ASSERT_EQ(seen.size(), TEST1_SIZE);
+}
+
+// SELECT l.colA, l.colB, r.colA, r.colB FROM test_1 l JOIN test_1 r ON l.colB = r.colB, serial and parallel
+TEST_F(ExecutorTest, HashJoinParallelTest) {
+  const Schema *out_schema1;
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema2;
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto col_a = MakeColumnValueExpression(schema, 0, "colA");
+    auto col_b = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+    out_schema2 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+
+  const Schema *out_final;
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto left_a = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto left_b = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto right_a = MakeColumnValueExpression(*out_schema2, 1, "colA");
+    auto right_b = MakeColumnValueExpression(*out_schema2, 1, "colB");
+    out_final = MakeOutputSchema({{"left_colA", left_a}, {"left_colB", left_b}, {"right_colA", right_a},
+                                  {"right_colB", right_b}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, left_b, right_b);
+  }
+
+  std::vector<Tuple> serial_result;
+  GetExecutionEngine()->Execute(join_plan.get(), &serial_result, GetTxn(), GetExecutorContext());
+
+  GetExecutorContext()->SetParallelism(4);
+  std::vector<Tuple> parallel_result;
+  GetExecutionEngine()->Execute(join_plan.get(), &parallel_result, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(serial_result.size(), parallel_result.size());
+
+  int64_t serial_sum = 0;
+  int64_t parallel_sum = 0;
+  for (size_t i = 0; i < serial_result.size(); i++) {
+    serial_sum += serial_result[i].GetValue(out_final, 0).GetAs<int32_t>();
+    auto &tuple = parallel_result[i];
+    ASSERT_EQ(tuple.GetValue(out_final, 1).GetAs<int32_t>(), tuple.GetValue(out_final, 3).GetAs<int32_t>());
+    parallel_sum += tuple.GetValue(out_final, 0).GetAs<int32_t>();
+  }
+  ASSERT_EQ(serial_sum, parallel_sum);
+
+  // A budget the left side just fits into makes the join read the right side in several chunks
+  auto memory_budget = GetExecutorContext()->GetMemoryBudget();
+  GetExecutorContext()->SetMemoryBudget(1000 * (sizeof(std::vector<Value>) + 2 * sizeof(Value) + 8) * 5 / 4);
+  std::vector<Tuple> chunked_result;
+  GetExecutionEngine()->Execute(join_plan.get(), &chunked_result, GetTxn(), GetExecutorContext());
+  GetExecutorContext()->SetMemoryBudget(memory_budget);
+  ASSERT_EQ(serial_result.size(), chunked_result.size());
+  int64_t chunked_sum = 0;
+  for (auto &tuple : chunked_result) {
+    ASSERT_EQ(tuple.GetValue(out_final, 1).GetAs<int32_t>(), tuple.GetValue(out_final, 3).GetAs<int32_t>());
+    chunked_sum += tuple.GetValue(out_final, 0).GetAs<int32_t>();
+  }
+  ASSERT_EQ(serial_sum, chunked_sum);
+
+  // The same query on the workers of a shared scheduler, and once more after it was cancelled
+  TaskScheduler scheduler(2);
+  auto group = scheduler.CreateTaskGroup(0, 2);
+  GetExecutorContext()->SetTaskGroup(group.get());
+  std::vector<Tuple> scheduled_result;
+  ASSERT_TRUE(GetExecutionEngine()->Execute(join_plan.get(), &scheduled_result, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(serial_result.size(), scheduled_result.size());
+  group->Cancel();
+  std::vector<Tuple> cancelled_result;
+  ASSERT_FALSE(GetExecutionEngine()->Execute(join_plan.get(), &cancelled_result, GetTxn(), GetExecutorContext()));
+  GetExecutorContext()->SetTaskGroup(nullptr);
+  GetExecutorContext()->SetParallelism(1);
+}
+
+// SELECT l.colA, r.colB FROM test_1 l JOIN test_1 r ON l.colA = r.colA WHERE l.colA < 100
+TEST_F(ExecutorTest, HashJoinRuntimeFilterTest) {
+  const Schema *out_schema1;
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema2;
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto col_a = MakeColumnValueExpression(schema, 0, "colA");
+    auto col_b = MakeColumnValueExpression(schema, 0, "colB");
+    auto const100 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(100));
+    auto predicate = MakeComparisonExpression(col_a, const100, ComparisonType::LessThan);
+    out_schema1 = MakeOutputSchema({{"colA", col_a}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, predicate, table_info->oid_);
+    out_schema2 = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+
+  const Schema *out_final;
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto left_a = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto right_a = MakeColumnValueExpression(*out_schema2, 1, "colA");
+    auto right_b = MakeColumnValueExpression(*out_schema2, 1, "colB");
+    out_final = MakeOutputSchema({{"colA", left_a}, {"colB", right_b}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, left_a, right_a);
+  }
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  size_t num_results = 0;
+  while (executor->Next(&tuple, &rid)) {
+    ASSERT_LT(tuple.GetValue(out_final, 0).GetAs<int32_t>(), 100);
+    num_results++;
+  }
+  ASSERT_EQ(num_results, 100);
+
+  // the right scan checked every row and dropped most rows without a partner before the join saw them
+  auto filter = dynamic_cast<HashJoinExecutor *>(executor.get())->GetRuntimeFilter();
+  ASSERT_NE(filter, nullptr);
+  ASSERT_EQ(filter->GetRowsChecked(), TEST1_SIZE);
+  ASSERT_GE(filter->GetRowsEliminated(), 850);
+  ASSERT_LE(filter->GetRowsEliminated(), TEST1_SIZE - 100);
+}
+
 // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
 TEST_F(ExecutorTest, SimpleAggregationTest) {
   const Schema *scan_schema;
@@ -1460,6 +1984,38 @@ TEST_F(ExecutorTest, SimpleAggregationTest) {
   ASSERT_EQ(result_set.size(), 1);
 }
 
+// MIN/MAX of VARCHAR inputs and overflowing integer aggregates, on the aggregation hash table itself
+TEST_F(ExecutorTest, AggregationHashTableTest) {
+  Schema schema{{Column{"name", TypeId::VARCHAR, 16}, Column{"val", TypeId::INTEGER}}};
+  auto name = MakeColumnValueExpression(schema, 0, "name");
+  auto val = MakeColumnValueExpression(schema, 0, "val");
+  std::vector<const AbstractExpression *> agg_exprs{name, name, val};
+  std::vector<AggregationType> agg_types{AggregationType::MinAggregate, AggregationType::MaxAggregate,
+                                         AggregationType::SumAggregate};
+  auto insert = [](SimpleAggregationHashTable *table, const std::string &name, int32_t val) {
+    auto name_value = ValueFactory::GetVarcharValue(name);
+    auto val_value = ValueFactory::GetIntegerValue(val);
+    table->InsertCombine(AggregateKey{{}}, AggregateValue{{name_value, name_value, val_value}});
+  };
+
+  // Partial aggregates of VARCHAR inputs merge like those of numeric inputs
+  SimpleAggregationHashTable table{agg_exprs, agg_types};
+  SimpleAggregationHashTable partial{agg_exprs, agg_types};
+  insert(&table, "pear", 1);
+  insert(&table, "fig", 2);
+  insert(&partial, "apple", 3);
+  insert(&partial, "quince", 4);
+  table.Merge(partial);
+  auto aggregates = table.Begin().Val().aggregates_;
+  ASSERT_EQ(aggregates[0].ToString(), "apple");
+  ASSERT_EQ(aggregates[1].ToString(), "quince");
+  ASSERT_EQ(aggregates[2].GetAs<int32_t>(), 10);
+
+  // An INTEGER sum that does not fit into an INTEGER throws instead of wrapping around
+  insert(&table, "date", BUSTUB_INT32_MAX);
+  ASSERT_THROW(table.Begin().Val(), Exception);
+}
+
 // SELECT count(col_a), col_b, sum(col_c) FROM test_1 Group By col_b HAVING count(col_a) > 100
 TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   const Schema *scan_schema;
@@ -1513,6 +2069,398 @@ TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   }
 }
 
+// SELECT COUNT(colA), SUM(colA), MIN(colA), MAX(colA), colB FROM test_1 GROUP BY colB HAVING COUNT(colA) > 0,
+// run serially and with two-phase parallel aggregation
+TEST_F(ExecutorTest, ParallelGroupByAggregation) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto scan_col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto scan_col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", scan_col_a}, {"colB", scan_col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+
+  const AbstractExpression *col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                         AggregationType::MinAggregate, AggregationType::MaxAggregate};
+  auto *agg_schema = MakeOutputSchema({{"countA", MakeAggregateValueExpression(false, 0)},
+                                       {"sumA", MakeAggregateValueExpression(false, 1)},
+                                       {"minA", MakeAggregateValueExpression(false, 2)},
+                                       {"maxA", MakeAggregateValueExpression(false, 3)},
+                                       {"colB", MakeAggregateValueExpression(true, 0)}});
+  const AbstractExpression *const0 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(0));
+  const AbstractExpression *having =
+      MakeComparisonExpression(MakeAggregateValueExpression(false, 0), const0, ComparisonType::GreaterThan);
+  AggregationPlanNode agg_plan{agg_schema, &scan_plan, having, {col_b}, {col_a, col_a, col_a, col_a},
+                                std::move(agg_types)};
+
+  auto run = [&](uint32_t parallelism) {
+    GetExecutorContext()->SetParallelism(parallelism);
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::map<int32_t, std::vector<int32_t>> groups;
+    for (const auto &tuple : result_set) {
+      auto &group = groups[tuple.GetValue(agg_schema, 4).GetAs<int32_t>()];
+      EXPECT_TRUE(group.empty());
+      for (uint32_t i = 0; i < 4; i++) {
+        group.push_back(tuple.GetValue(agg_schema, i).GetAs<int32_t>());
+      }
+    }
+    return groups;
+  };
+  auto serial = run(1);
+  auto parallel = run(4);
+  ASSERT_EQ(serial.size(), 10);
+  ASSERT_EQ(serial, parallel);
+}
+
+/** A sequential scan of a table whose tuples were inserted in the order of one of its columns */
+class OrderedSeqScanPlanNode : public SeqScanPlanNode {
+ public:
+  OrderedSeqScanPlanNode(const Schema *output, table_oid_t table_oid, uint32_t sort_col_idx)
+      : SeqScanPlanNode(output, nullptr, table_oid), sort_col_idx_(sort_col_idx) {}
+
+  auto GetOutputOrdering() const -> std::vector<uint32_t> override { return {sort_col_idx_}; }
+
+ private:
+  uint32_t sort_col_idx_;
+};
+
+// SELECT COUNT(colB), SUM(colB), MIN(colB), MAX(colB) FROM test_5 GROUP BY colA HAVING MAX(colB) > 19,
+// over input sorted on colA
+TEST_F(ExecutorTest, StreamingGroupByAggregation) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_5");
+  auto &schema = table_info->schema_;
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 100; i++) {
+    raw_vals.push_back({ValueFactory::GetBigIntValue(i / 10), ValueFactory::GetIntegerValue(i)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  auto scan_col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto scan_col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", scan_col_a}, {"colB", scan_col_b}});
+  OrderedSeqScanPlanNode scan_plan{scan_schema, table_info->oid_, 0};
+
+  const AbstractExpression *col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                         AggregationType::MinAggregate, AggregationType::MaxAggregate};
+  auto *agg_schema = MakeOutputSchema({{"countB", MakeAggregateValueExpression(false, 0)},
+                                       {"sumB", MakeAggregateValueExpression(false, 1)},
+                                       {"minB", MakeAggregateValueExpression(false, 2)},
+                                       {"maxB", MakeAggregateValueExpression(false, 3)}});
+  const AbstractExpression *const19 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(19));
+  const AbstractExpression *having =
+      MakeComparisonExpression(MakeAggregateValueExpression(false, 3), const19, ComparisonType::GreaterThan);
+  AggregationPlanNode agg_plan{agg_schema, &scan_plan, having, {col_a}, {col_b, col_b, col_b, col_b},
+                               std::move(agg_types)};
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &agg_plan);
+  ASSERT_NE(dynamic_cast<StreamingAggregationExecutor *>(executor.get()), nullptr);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  for (int32_t group = 2; group < 10; group++) {
+    ASSERT_TRUE(executor->Next(&tuple, &rid));
+    ASSERT_EQ(tuple.GetValue(agg_schema, 0).GetAs<int32_t>(), 10);
+    ASSERT_EQ(tuple.GetValue(agg_schema, 1).GetAs<int32_t>(), group * 100 + 45);
+    ASSERT_EQ(tuple.GetValue(agg_schema, 2).GetAs<int32_t>(), group * 10);
+    ASSERT_EQ(tuple.GetValue(agg_schema, 3).GetAs<int32_t>(), group * 10 + 9);
+  }
+  ASSERT_FALSE(executor->Next(&tuple, &rid));
+}
+
+// SELECT colA, colB, colC FROM test_1 ORDER BY colB ASC, colC DESC, in memory and spilled to sorted runs
+TEST_F(ExecutorTest, SortTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto scan_col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto scan_col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto scan_col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *scan_schema = MakeOutputSchema({{"colA", scan_col_a}, {"colB", scan_col_b}, {"colC", scan_col_c}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto col_c = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  SortPlanNode sort_plan{scan_schema, &scan_plan, {{OrderByType::ASC, col_b}, {OrderByType::DESC, col_c}}};
+  ASSERT_EQ(sort_plan.GetOutputOrdering(), std::vector<uint32_t>({1, 2}));
+
+  auto run = [&](size_t memory_budget, size_t *num_spilled_runs) {
+    GetExecutorContext()->SetMemoryBudget(memory_budget);
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &sort_plan);
+    executor->Init();
+    std::vector<std::pair<int32_t, int32_t>> keys;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      keys.emplace_back(tuple.GetValue(scan_schema, 1).GetAs<int32_t>(),
+                        tuple.GetValue(scan_schema, 2).GetAs<int32_t>());
+    }
+    *num_spilled_runs = dynamic_cast<SortExecutor *>(executor.get())->GetNumSpilledRuns();
+    return keys;
+  };
+
+  size_t num_spilled_runs;
+  auto in_memory = run(DEFAULT_EXECUTOR_MEMORY_BUDGET, &num_spilled_runs);
+  ASSERT_EQ(num_spilled_runs, 0);
+  ASSERT_EQ(in_memory.size(), TEST1_SIZE);
+  for (size_t i = 1; i < in_memory.size(); i++) {
+    ASSERT_TRUE(in_memory[i - 1].first < in_memory[i].first ||
+                (in_memory[i - 1].first == in_memory[i].first && in_memory[i - 1].second >= in_memory[i].second));
+  }
+
+  // A budget of two pages spills many runs and needs several merge passes
+  auto spilled = run(2 * PAGE_SIZE, &num_spilled_runs);
+  ASSERT_GT(num_spilled_runs, 2);
+  ASSERT_EQ(spilled, in_memory);
+}
+
+// SELECT colA, colB FROM test_1 ORDER BY colB, under the per-query memory limit
+TEST_F(ExecutorTest, QueryMemoryLimitTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *scan_schema = MakeOutputSchema(
+      {{"colA", MakeColumnValueExpression(schema, 0, "colA")}, {"colB", MakeColumnValueExpression(schema, 0, "colB")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  SortPlanNode sort_plan{scan_schema, &scan_plan, {{OrderByType::ASC, col_b}}};
+
+  // The sort buffer is allocated from an arena under the query arena, which is empty again once the query is done
+  auto *arena = GetExecutorContext()->GetArena();
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  ASSERT_GT(arena->GetPeakBytes(), 0);
+  ASSERT_EQ(arena->GetUsedBytes(), 0);
+
+  // A query over the limit fails instead of returning what it produced so far
+  GetExecutorContext()->SetQueryMemoryLimit(1024);
+  result_set.clear();
+  ASSERT_FALSE(GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(arena->GetUsedBytes(), 0);
+  GetExecutorContext()->SetQueryMemoryLimit(DEFAULT_QUERY_MEMORY_LIMIT);
+}
+
+// SELECT DISTINCT colA FROM test_1, a self join and a GROUP BY on colA, under a small per-query memory limit
+TEST_F(ExecutorTest, QueryMemoryLimitHashTableTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(table_info->schema_, 0, "colA")}});
+  SeqScanPlanNode left_scan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode right_scan{scan_schema, nullptr, table_info->oid_};
+  DistinctPlanNode distinct_plan{scan_schema, &left_scan};
+  auto left_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto right_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *join_schema = MakeOutputSchema({{"left_colA", left_a}, {"right_colA", right_a}});
+  HashJoinPlanNode join_plan{join_schema, {&left_scan, &right_scan}, left_a, right_a};
+  auto *agg_schema = MakeOutputSchema(
+      {{"colA", MakeAggregateValueExpression(true, 0)}, {"countA", MakeAggregateValueExpression(false, 0)}});
+  AggregationPlanNode agg_plan{agg_schema, &left_scan, nullptr, {left_a}, {left_a}, {AggregationType::CountAggregate}};
+
+  // colA is unique, so the hash tables grow with every row and the whole table does not fit into the limit
+  auto *arena = GetExecutorContext()->GetArena();
+  GetExecutorContext()->SetQueryMemoryLimit(4096);
+
+  // The distinct charges its keys as it finds them, so the limit is hit by Next() after some rows were produced
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &distinct_plan);
+  executor->Init();
+  size_t num_rows = 0;
+  Tuple tuple;
+  RID rid;
+  auto drain = [&] {
+    while (executor->Next(&tuple, &rid)) {
+      num_rows++;
+    }
+  };
+  ASSERT_THROW(drain(), Exception);
+  ASSERT_GT(num_rows, 0);
+  ASSERT_LT(num_rows, TEST1_SIZE);
+  executor.reset();
+  arena->Reset();
+  ASSERT_EQ(arena->GetUsedBytes(), 0);
+
+  // The engine reports the failure, whatever rows were handed out before it are not a result
+  std::vector<Tuple> result_set;
+  ASSERT_FALSE(GetExecutionEngine()->Execute(&distinct_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_LT(result_set.size(), TEST1_SIZE);
+  ASSERT_EQ(arena->GetUsedBytes(), 0);
+
+  for (uint32_t parallelism : {1, 4}) {
+    GetExecutorContext()->SetParallelism(parallelism);
+    result_set.clear();
+    ASSERT_FALSE(GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext()));
+    ASSERT_EQ(arena->GetUsedBytes(), 0);
+    ASSERT_FALSE(GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext()));
+    ASSERT_EQ(arena->GetUsedBytes(), 0);
+  }
+  GetExecutorContext()->SetParallelism(1);
+
+  // Under the default limit the same queries succeed
+  GetExecutorContext()->SetQueryMemoryLimit(DEFAULT_QUERY_MEMORY_LIMIT);
+  result_set.clear();
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&distinct_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  result_set.clear();
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  result_set.clear();
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+}
+
+// SELECT colA, colC FROM test_1 ORDER BY colC DESC, colA ASC LIMIT 10, as a TopN plan and as a limit over a sort
+TEST_F(ExecutorTest, TopNTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto scan_col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto scan_col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *scan_schema = MakeOutputSchema({{"colA", scan_col_a}, {"colC", scan_col_c}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto col_c = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  SortPlanNode sort_plan{scan_schema, &scan_plan, {{OrderByType::DESC, col_c}, {OrderByType::ASC, col_a}}};
+  LimitPlanNode limit_plan{scan_schema, &sort_plan, 10};
+  TopNPlanNode topn_plan{scan_schema, &scan_plan, {{OrderByType::DESC, col_c}, {OrderByType::ASC, col_a}}, 10};
+
+  auto run = [&](const AbstractPlanNode *plan, size_t limit) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    Tuple tuple;
+    RID rid;
+    while (rows.size() < limit && executor->Next(&tuple, &rid)) {
+      rows.emplace_back(tuple.GetValue(scan_schema, 1).GetAs<int32_t>(),
+                        tuple.GetValue(scan_schema, 0).GetAs<int32_t>());
+    }
+    return rows;
+  };
+
+  auto expected = run(&sort_plan, 10);
+  ASSERT_EQ(expected.size(), 10);
+  ASSERT_EQ(run(&topn_plan, TEST1_SIZE), expected);
+  ASSERT_NE(dynamic_cast<TopNExecutor *>(ExecutorFactory::CreateExecutor(GetExecutorContext(), &limit_plan).get()),
+            nullptr);
+  ASSERT_EQ(run(&limit_plan, TEST1_SIZE), expected);
+}
+
+// SELECT l.colA, r.colA FROM test_1 l JOIN test_1 r ON l.colB = r.colB, merging inputs sorted on colB
+TEST_F(ExecutorTest, MergeJoinTest) {
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto scan_col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto scan_col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", scan_col_a}, {"colB", scan_col_b}});
+  SeqScanPlanNode left_scan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode right_scan{scan_schema, nullptr, table_info->oid_};
+  auto col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  SortPlanNode left_sort{scan_schema, &left_scan, {{OrderByType::ASC, col_b}}};
+  SortPlanNode right_sort{scan_schema, &right_scan, {{OrderByType::ASC, col_b}}};
+
+  auto left_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto left_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto right_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto right_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *out_schema = MakeOutputSchema({{"left_colA", left_a}, {"right_colA", right_a}});
+  // colB only has ten distinct values, so both sides consist of long runs of duplicate keys
+  MergeJoinPlanNode merge_join_plan{out_schema, {&left_sort, &right_sort}, left_b, right_b};
+  HashJoinPlanNode hash_join_plan{out_schema, {&left_scan, &right_scan}, left_b, right_b};
+
+  auto run = [&](const AbstractPlanNode *plan) {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    rows.reserve(result_set.size());
+    for (const auto &tuple : result_set) {
+      rows.emplace_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>(),
+                        tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+
+  auto merged = run(&merge_join_plan);
+  ASSERT_GT(merged.size(), TEST1_SIZE);
+  ASSERT_EQ(merged, run(&hash_join_plan));
+
+  // An input that is not sorted on its join key is reported instead of producing a wrong result
+  MergeJoinPlanNode unsorted_plan{out_schema, {&left_scan, &right_sort}, left_b, right_b};
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &unsorted_plan);
+  executor->Init();
+  auto drain = [&] {
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+    }
+  };
+  ASSERT_THROW(drain(), Exception);
+}
+
+// SELECT test_1.colB, COUNT(*), SUM(test_2.col1) FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1 GROUP BY
+// test_1.colB, pushed through pipelines and pulled through executors
+TEST_F(ExecutorTest, PipelineExecutionTest) {
+  auto *ctx = GetExecutorContext();
+  PipelineExecutionEngine pipeline_engine{ctx->GetBufferPoolManager(), ctx->GetTransactionManager(), ctx->GetCatalog()};
+
+  auto *table1 = ctx->GetCatalog()->GetTable("test_1");
+  auto *schema1 = MakeOutputSchema({{"colA", MakeColumnValueExpression(table1->schema_, 0, "colA")},
+                                    {"colB", MakeColumnValueExpression(table1->schema_, 0, "colB")}});
+  SeqScanPlanNode scan1{schema1, nullptr, table1->oid_};
+  auto *table2 = ctx->GetCatalog()->GetTable("test_2");
+  auto *schema2 = MakeOutputSchema({{"col1", MakeColumnValueExpression(table2->schema_, 0, "col1")}});
+  SeqScanPlanNode scan2{schema2, nullptr, table2->oid_};
+
+  auto col_a = MakeColumnValueExpression(*schema1, 0, "colA");
+  auto col_b = MakeColumnValueExpression(*schema1, 0, "colB");
+  auto col1 = MakeColumnValueExpression(*schema2, 1, "col1");
+  auto *join_schema = MakeOutputSchema({{"colB", col_b}, {"col1", col1}});
+  HashJoinPlanNode join_plan{join_schema, {&scan1, &scan2}, col_a, col1};
+
+  auto join_col_b = MakeColumnValueExpression(*join_schema, 0, "colB");
+  auto join_col1 = MakeColumnValueExpression(*join_schema, 0, "col1");
+  auto *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                       {"count", MakeAggregateValueExpression(false, 0)},
+                                       {"sum", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &join_plan,
+                               nullptr,
+                               {join_col_b},
+                               {join_col1, join_col1},
+                               {AggregationType::CountAggregate, AggregationType::SumAggregate}};
+
+  auto groups = [&](const std::vector<Tuple> &result_set) {
+    std::map<int32_t, std::pair<int32_t, int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      rows[tuple.GetValue(agg_schema, 0).GetAs<int32_t>()] = {tuple.GetValue(agg_schema, 1).GetAs<int32_t>(),
+                                                              tuple.GetValue(agg_schema, 2).GetAs<int32_t>()};
+    }
+    return rows;
+  };
+  std::vector<Tuple> pulled;
+  GetExecutionEngine()->Execute(&agg_plan, &pulled, GetTxn(), ctx);
+  ASSERT_EQ(pulled.size(), 10);
+  for (uint32_t parallelism : {1, 4}) {
+    ctx->SetParallelism(parallelism);
+    std::vector<Tuple> pushed;
+    ASSERT_TRUE(pipeline_engine.Execute(&agg_plan, &pushed, GetTxn(), ctx));
+    ASSERT_EQ(pushed.size(), pulled.size());
+    ASSERT_EQ(groups(pushed), groups(pulled));
+
+    // A limit stops its pipeline early; a sort below it runs as an executor tree feeding the pipeline
+    LimitPlanNode limit_plan{schema1, &scan1, 10};
+    pushed.clear();
+    ASSERT_TRUE(pipeline_engine.Execute(&limit_plan, &pushed, GetTxn(), ctx));
+    ASSERT_EQ(pushed.size(), 10);
+    SortPlanNode sort_plan{schema1, &scan1, {{OrderByType::DESC, col_a}}};
+    LimitPlanNode top_plan{schema1, &sort_plan, 3};
+    pushed.clear();
+    ASSERT_TRUE(pipeline_engine.Execute(&top_plan, &pushed, GetTxn(), ctx));
+    ASSERT_EQ(pushed.size(), 3);
+    ASSERT_EQ(pushed[0].GetValue(schema1, 0).GetAs<int32_t>(), TEST1_SIZE - 1);
+    ASSERT_EQ(pushed[2].GetValue(schema1, 0).GetAs<int32_t>(), TEST1_SIZE - 3);
+  }
+  ctx->SetParallelism(1);
+}
+
 // SELECT colA, colB FROM test_3 LIMIT 10
 TEST_F(ExecutorTest, SimpleLimitTest) {
   auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
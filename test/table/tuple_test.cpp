@@ -12,15 +12,20 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/task_scheduler.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "storage/page/table_directory_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +76,283 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, ViewAndMoveTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::BIGINT};
+  Schema schema{{col1, col2}};
+  Tuple tuple{{ValueFactory::GetVarcharValue("hello"), ValueFactory::GetBigIntValue(42)}, &schema};
+
+  // A view and its copies share the bytes of the owner
+  Tuple view = Tuple::View(tuple.GetData(), tuple.GetLength(), RID(1, 2));
+  Tuple view_copy = view;
+  EXPECT_FALSE(view_copy.IsAllocated());
+  EXPECT_EQ(view_copy.GetData(), tuple.GetData());
+  EXPECT_EQ(view_copy.GetRid(), RID(1, 2));
+  EXPECT_EQ(view_copy.GetValue(&schema, 0).GetAs<char *>(), std::string("hello"));
+
+  // Materializing detaches the view from the owner
+  view_copy.Materialize();
+  EXPECT_TRUE(view_copy.IsAllocated());
+  EXPECT_NE(view_copy.GetData(), tuple.GetData());
+  EXPECT_EQ(view_copy.GetValue(&schema, 1).GetAs<int64_t>(), 42);
+
+  // Moving hands over the buffer instead of copying it
+  const char *data = view_copy.GetData();
+  Tuple moved = std::move(view_copy);
+  EXPECT_EQ(moved.GetData(), data);
+  EXPECT_TRUE(moved.IsAllocated());
+  EXPECT_EQ(moved.GetValue(&schema, 1).GetAs<int64_t>(), 42);
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, BulkInsertTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 64};
+  Schema schema{{col1, col2}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+
+  RID first_rid;
+  Tuple first{{ValueFactory::GetIntegerValue(-1), ValueFactory::GetVarcharValue("first")}, &schema};
+  ASSERT_TRUE(table->InsertTuple(first, &first_rid, transaction));
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 5000; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("bulk")},
+                        &schema);
+  }
+  std::vector<RID> rids;
+  ASSERT_TRUE(table->InsertTuples(tuples, &rids, transaction));
+  ASSERT_EQ(rids.size(), tuples.size());
+
+  // The batch continues on the last page and fills the pages it appends in order
+  auto page_ids = table->GetPageIds();
+  ASSERT_GT(page_ids.size(), 1);
+  EXPECT_EQ(rids.front(), RID(first_rid.GetPageId(), first_rid.GetSlotNum() + 1));
+  size_t page_idx = 0;
+  for (size_t i = 0; i < rids.size(); i++) {
+    while (page_ids[page_idx] != rids[i].GetPageId()) {
+      page_idx++;
+      ASSERT_LT(page_idx, page_ids.size());
+    }
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, transaction));
+    EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), static_cast<int32_t>(i));
+  }
+
+  // A tuple that does not fit on a page rejects the whole batch
+  std::string too_long(PAGE_SIZE, 'x');
+  Column long_col{"c", TypeId::VARCHAR, PAGE_SIZE + 1};
+  Schema long_schema{{long_col}};
+  std::vector<Tuple> too_large{tuples[0], Tuple{{ValueFactory::GetVarcharValue(too_long)}, &long_schema}};
+  EXPECT_FALSE(table->InsertTuples(too_large, &rids, transaction));
+  EXPECT_TRUE(rids.empty());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, FreeSpaceMapTest) {
+  FreeSpaceMap map;
+  EXPECT_EQ(map.FindPage(1, 0), INVALID_PAGE_ID);
+  map.AddPage(10, 0);
+  map.AddPage(11, 100);
+  map.AddPage(12, 4000);
+  EXPECT_EQ(map.FindPage(50, 0), 11);
+  EXPECT_EQ(map.FindPage(50, 2), 12);
+  EXPECT_EQ(map.FindPage(200, 1), 12);
+  EXPECT_EQ(map.FindPage(5000, 0), INVALID_PAGE_ID);
+  map.Update(12, 0);
+  EXPECT_EQ(map.FindPage(50, 2), 11);
+  EXPECT_EQ(map.FindPage(200, 0), INVALID_PAGE_ID);
+
+  // Space freed by deletes is reused before the table grows
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 64};
+  Schema schema{{col1, col2}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+  Tuple tuple{{ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("free space")}, &schema};
+  std::vector<RID> rids(2000);
+  for (auto &rid : rids) {
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  auto num_pages = table->GetPageIds().size();
+  ASSERT_GT(num_pages, 2);
+  std::vector<RID> deleted;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == table->GetFirstPageId()) {
+      ASSERT_TRUE(lock_manager->LockExclusive(transaction, rid));
+      ASSERT_TRUE(table->MarkDelete(rid, transaction));
+      deleted.push_back(rid);
+    }
+  }
+  ASSERT_FALSE(deleted.empty());
+  for (const auto &rid : deleted) {
+    table->ApplyDelete(rid, transaction);
+  }
+  for (size_t i = 0; i < deleted.size(); i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  EXPECT_EQ(table->GetPageIds().size(), num_pages);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, PageDirectoryTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 1000};
+  Schema schema{{col1, col2}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, nullptr, nullptr, transaction);
+
+  // Enough pages to need a second directory page
+  std::string payload(1000, 'x');
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 4200; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(payload)},
+                        &schema);
+  }
+  std::vector<RID> rids;
+  ASSERT_TRUE(table->InsertTuples(tuples, &rids, transaction));
+  auto page_ids = table->GetPageIds();
+  ASSERT_GT(page_ids.size(), TableDirectoryPage::CAPACITY);
+  ASSERT_EQ(table->GetNumPages(), page_ids.size());
+  ASSERT_EQ(table->GetPageId(page_ids.size() - 1), page_ids.back());
+  ASSERT_EQ(table->GetPageId(page_ids.size()), INVALID_PAGE_ID);
+  // Pages come in extents allocated back to back
+  ASSERT_EQ(page_ids[2], page_ids[1] + 1);
+
+  // Reopening the table reads its directory instead of the chain
+  auto first_page_id = table->GetFirstPageId();
+  delete table;
+  table = new TableHeap(buffer_pool_manager, nullptr, nullptr, first_page_id);
+  ASSERT_EQ(table->GetPageIds(), page_ids);
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuples[0], &rid, transaction));
+  ASSERT_EQ(table->GetNumPages(), page_ids.size());
+  size_t num_tuples = 0;
+  for (auto iter = table->Begin(transaction); iter != table->End(); ++iter) {
+    num_tuples++;
+  }
+  ASSERT_EQ(num_tuples, tuples.size() + 1);
+
+  // A table whose directory is lost gets it rebuilt from the chain
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(first_page_id));
+  first_page->SetDirectoryPageId(INVALID_PAGE_ID);
+  buffer_pool_manager->UnpinPage(first_page_id, true);
+  delete table;
+  table = new TableHeap(buffer_pool_manager, nullptr, nullptr, first_page_id);
+  ASSERT_EQ(table->GetPageIds(), page_ids);
+  delete table;
+  table = new TableHeap(buffer_pool_manager, nullptr, nullptr, first_page_id);
+  ASSERT_EQ(table->GetPageIds(), page_ids);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, VacuumTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 1000};
+  Schema schema{{col1, col2}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+  auto make_tuple = [&](int a, size_t length) {
+    return Tuple{{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::string(length, 'x'))}, &schema};
+  };
+  std::vector<RID> rids(2000);
+  for (size_t i = 0; i < rids.size(); i++) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, 100), &rids[i], transaction));
+  }
+  auto num_pages = table->GetNumPages();
+  std::vector<bool> deleted(rids.size(), false);
+  txn_id_t delete_txn_id = 1;
+  auto delete_tuples = [&](const std::function<bool(size_t)> &predicate) {
+    // Each round of deletes is a transaction of its own, which unlocks the rids as it applies the deletes
+    Transaction delete_txn(delete_txn_id++);
+    std::vector<RID> to_delete;
+    for (size_t i = 0; i < rids.size(); i++) {
+      if (!deleted[i] && predicate(i)) {
+        ASSERT_TRUE(lock_manager->LockExclusive(&delete_txn, rids[i]));
+        ASSERT_TRUE(table->MarkDelete(rids[i], &delete_txn));
+        to_delete.push_back(rids[i]);
+        deleted[i] = true;
+      }
+    }
+    for (const auto &rid : to_delete) {
+      table->ApplyDelete(rid, &delete_txn);
+    }
+  };
+
+  // The first page is full, but deleting three tuples in front of the last one leaves holes an update can use
+  auto first_page_id = rids[0].GetPageId();
+  ASSERT_EQ(rids[4].GetPageId(), first_page_id);
+  delete_tuples([](size_t i) { return i >= 1 && i <= 3; });
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(0, 300), rids[0], transaction));
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, transaction));
+  EXPECT_EQ(tuple.GetLength(), make_tuple(0, 300).GetLength());
+  ASSERT_TRUE(table->GetTuple(rids[4], &tuple, transaction));
+  EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), 4);
+
+  // Vacuuming reclaims the holes of deleted tuples, once
+  delete_tuples([](size_t i) { return i % 2 == 1; });
+  TaskScheduler scheduler(2);
+  auto group = scheduler.CreateTaskGroup(-1);
+  EXPECT_GT(table->Vacuum(group.get()), 0);
+  EXPECT_EQ(table->Vacuum(), 0);
+  size_t num_tuples = 0;
+  for (size_t i = 0; i < rids.size(); i++) {
+    if (!deleted[i]) {
+      ASSERT_TRUE(table->GetTuple(rids[i], &tuple, transaction));
+      EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), static_cast<int32_t>(i));
+      num_tuples++;
+    }
+  }
+
+  // Inserts reuse the freed slots and space before the table grows
+  for (size_t i = num_tuples; i < rids.size(); i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, 100), &rid, transaction));
+  }
+  EXPECT_EQ(table->GetNumPages(), num_pages);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub